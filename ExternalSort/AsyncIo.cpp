@@ -0,0 +1,291 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    AsyncIo.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the IoBackend class's functions, which carry out
+//                    block reads and writes on a background thread.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+
+#include "AsyncIo.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  IoBackend
+//
+//        Purpose:  Starts the I/O thread.
+//
+//      Parameter:  maxInFlight is the maximum number of requests that can be waiting at once. Each stage
+//                  of the sort only has a request in flight for a buffer it owns, so the number of
+//                  requests is bounded by the buffers that fit in memory, and this is only a safeguard.
+//                  Submitting a request while the maximum number are waiting waits for one to start.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+IoBackend::IoBackend(int maxInFlight)
+	: requests(maxInFlight + 1), failureToken(nullptr), failed(false)
+{
+	ioThread = std::thread(&IoBackend::run, this);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~IoBackend
+//
+//        Purpose:  Finishes the requests that have been submitted, and stops the I/O thread.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+IoBackend::~IoBackend()
+{
+	requests.push(nullptr);
+
+	ioThread.join();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readBlock
+//
+//        Purpose:  Submits a request to read a block from the current position of a file. Reads from the
+//                  same file are carried out in the order they are submitted.
+//
+//      Parameter:  request is the request to submit, which must not be in flight.
+//
+//      Parameter:  file is the file to read from.
+//
+//      Parameter:  data receives the block.
+//
+//      Parameter:  numBytes is the size of the block in bytes.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::readBlock(IoRequest& request, std::ifstream& file, void* data, std::streamsize numBytes)
+{
+	request.readFrom = &file;
+	request.writeTo = nullptr;
+	request.data = (char*)data;
+	request.numBytes = numBytes;
+
+	submit(request);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  writeBlock
+//
+//        Purpose:  Submits a request to write a block to the end of a file. Writes to the same file are
+//                  carried out in the order they are submitted.
+//
+//      Parameter:  request is the request to submit, which must not be in flight.
+//
+//      Parameter:  file is the file to write to.
+//
+//      Parameter:  data is the block, which must not change until the request has been awaited.
+//
+//      Parameter:  numBytes is the size of the block in bytes.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::writeBlock(IoRequest& request, std::ofstream& file, const void* data, std::streamsize numBytes)
+{
+	request.readFrom = nullptr;
+	request.writeTo = &file;
+	request.data = (char*)data;
+	request.numBytes = numBytes;
+
+	submit(request);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  writeFile
+//
+//        Purpose:  Submits a request to write a block to a new file, replacing any file already at the
+//                  path.
+//
+//      Parameter:  request is the request to submit, which must not be in flight.
+//
+//      Parameter:  path is the path of the file to write.
+//
+//      Parameter:  data is the block, which must not change until the request has been awaited.
+//
+//      Parameter:  numBytes is the size of the block in bytes.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::writeFile(IoRequest& request, const std::string& path, const void* data, std::streamsize numBytes)
+{
+	request.readFrom = nullptr;
+	request.writeTo = nullptr;
+	request.path = path;
+	request.data = (char*)data;
+	request.numBytes = numBytes;
+
+	submit(request);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  cancelOnFailure
+//
+//        Purpose:  Sets the token that is cancelled when a request fails. The command then stops as if it
+//                  had been cancelled, and removes its temp files and output on the way out.
+//
+//      Parameter:  token is the token to cancel, or a null pointer to exit the program on a failure.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::cancelOnFailure(CancelToken* token)
+{
+	failureToken = token;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  fail
+//
+//        Purpose:  Reports that a file could not be opened, read, or written. The command cannot go on
+//                  without writing a wrong output, so the failure token is cancelled, or the program exits
+//                  with an error if there is none. Only the first failure is printed, since the ones after
+//                  it are usually caused by it.
+//
+//      Parameter:  message describes the failure.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::fail(const std::string& message)
+{
+	if (!failed)
+		std::cout << message << std::endl;
+
+	failed = true;
+
+	if (failureToken == nullptr)
+		exit(1);
+
+	failureToken->cancel();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  hasFailed
+//
+//        Purpose:  Checks whether the command was stopped by a failed request.
+//
+//        Returns:  True if a file could not be opened, read, or written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IoBackend::hasFailed() const
+{
+	return failed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  isDone
+//
+//        Purpose:  Checks whether a request has been carried out, without waiting.
+//
+//      Parameter:  request is the request to check.
+//
+//        Returns:  True if the request is not in flight.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IoBackend::isDone(const IoRequest& request)
+{
+	return request.done.load(std::memory_order_acquire);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  await
+//
+//        Purpose:  Waits until a request has been carried out. Returns right away if it is not in flight.
+//                  Every block the sort reads is within the file and every block it writes is needed, so
+//                  a request that failed is reported as a failure of the backend.
+//
+//      Parameter:  request is the request to wait for.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::await(IoRequest& request)
+{
+	int numWaits = 0;
+
+	while (!isDone(request))
+		waitForRing(numWaits);
+
+	if (!request.failed)
+		return;
+
+	if (request.readFrom != nullptr)
+		fail("Error reading a file: only " + std::to_string(request.numBytesDone) + " of " + std::to_string(request.numBytes) + " bytes could be read.");
+	else if (request.writeTo != nullptr)
+		fail("Error writing a file: a block of " + std::to_string(request.numBytes) + " bytes could not be written.");
+	else
+		fail("Error writing temp file " + request.path + ".");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  submit
+//
+//        Purpose:  Passes a request to the I/O thread.
+//
+//      Parameter:  request is the request to submit.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::submit(IoRequest& request)
+{
+	request.done.store(false, std::memory_order_relaxed);
+
+	requests.push(&request);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  run
+//
+//        Purpose:  Runs on the I/O thread. Carries out requests in the order they were submitted until the
+//                  backend is destroyed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IoBackend::run()
+{
+	while (true)
+	{
+		IoRequest* request = requests.pop();
+
+		if (request == nullptr)
+			return;
+
+		if (request->readFrom != nullptr)
+		{
+			request->readFrom->read(request->data, request->numBytes);
+
+			request->numBytesDone = request->readFrom->gcount();
+		}
+		else if (request->writeTo != nullptr)
+		{
+			request->writeTo->write(request->data, request->numBytes);
+
+			request->numBytesDone = request->writeTo->good() ? request->numBytes : 0;
+		}
+		else
+		{
+			std::ofstream outFile(request->path, std::ios::out | std::ios::binary);
+
+			outFile.write(request->data, request->numBytes);
+
+			// Closing the file flushes it, which is when a full device is usually found
+			outFile.close();
+
+			request->numBytesDone = outFile.fail() ? 0 : request->numBytes;
+		}
+
+		request->failed = request->numBytesDone != request->numBytes;
+
+		// Publish the request's result only after it has been carried out
+		request->done.store(true, std::memory_order_release);
+	}
+}
\ No newline at end of file
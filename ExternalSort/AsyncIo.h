@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  AsyncIo.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the IoRequest struct and the IoBackend class, which together let
+//                  the stages of the sort read and write blocks asynchronously. A stage submits a request
+//                  to read or write a block, goes on with other work, and awaits the request when it needs
+//                  the block, so code that overlaps I/O with sorting and merging reads like the sequential
+//                  code it replaces. Requests are carried out in the order they were submitted by the
+//                  backend's I/O thread, which takes them from a lock-free ring. A request that fails is
+//                  reported, and either cancels the command so that it removes its files, or exits.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "Cancellation.h"
+#include "RingBuffer.h"
+
+// A read or write of a block that has been submitted to an IoBackend. A request must not be submitted
+// again or destroyed until it has been awaited.
+struct IoRequest
+{
+	IoRequest()
+		: readFrom(nullptr), writeTo(nullptr), data(nullptr), numBytes(0), numBytesDone(0), failed(false), done(true)
+	{
+	}
+
+	// The file to read from, or a null pointer if this is a write
+	std::ifstream* readFrom;
+
+	// The file to write to, or a null pointer if the block is written to a new file at path
+	std::ofstream* writeTo;
+
+	// The path of the new file to write the block to
+	std::string path;
+
+	// The block being read or written
+	char* data;
+
+	// The size of the block in bytes
+	std::streamsize numBytes;
+
+	// The number of bytes the I/O thread read, or the size of the block once it has been written
+	std::streamsize numBytesDone;
+
+	// True if the file could not be opened, or the read came up short, or the write failed
+	bool failed;
+
+	// True once the I/O thread has finished the request
+	std::atomic<bool> done;
+};
+
+class IoBackend
+{
+public:
+	IoBackend(int);
+	~IoBackend();
+
+	void readBlock(IoRequest&, std::ifstream&, void*, std::streamsize);
+	void writeBlock(IoRequest&, std::ofstream&, const void*, std::streamsize);
+	void writeFile(IoRequest&, const std::string&, const void*, std::streamsize);
+
+	void cancelOnFailure(CancelToken*);
+	void fail(const std::string&);
+	bool hasFailed() const;
+
+	static bool isDone(const IoRequest&);
+	void await(IoRequest&);
+
+private:
+	void submit(IoRequest&);
+	void run();
+
+	// Requests waiting to be carried out, or a null pointer once the I/O thread should stop
+	MpscRing<IoRequest*> requests;
+
+	// The thread that carries out the requests
+	std::thread ioThread;
+
+	// The token cancelled when a request fails, so that the command removes its temp files and output,
+	// or a null pointer if a failure exits the program at once
+	CancelToken* failureToken;
+
+	// Whether a request has failed or a file could not be opened
+	bool failed;
+};
+
+#endif
\ No newline at end of file
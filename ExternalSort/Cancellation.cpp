@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    Cancellation.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the CancelToken class's functions, which let a
+//                    sort be cancelled or given a deadline.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Cancellation.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  CancelToken
+//
+//        Purpose:  Creates a token that is not cancelled and has no deadline.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+CancelToken::CancelToken()
+	: cancelled(false), deadline(std::chrono::steady_clock::duration::max().count())
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  cancel
+//
+//        Purpose:  Cancels the token. This only sets an atomic flag, so it can be called from any thread
+//                  or from a signal handler.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void CancelToken::cancel()
+{
+	cancelled = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  setDeadline
+//
+//        Purpose:  Makes the token cancel itself once a number of seconds have gone by.
+//
+//      Parameter:  seconds is the number of seconds from now.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void CancelToken::setDeadline(double seconds)
+{
+	std::chrono::steady_clock::time_point deadlineTime = std::chrono::steady_clock::now()
+		+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+
+	deadline = deadlineTime.time_since_epoch().count();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  isCancelled
+//
+//        Purpose:  Checks whether the token has been cancelled, cancelling it if its deadline has passed,
+//                  so that once it reports being cancelled it always does. The clock is only read if the
+//                  token has a deadline.
+//
+//        Returns:  True if the token is cancelled.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool CancelToken::isCancelled()
+{
+	if (cancelled)
+		return true;
+
+	std::chrono::steady_clock::rep deadlineTicks = deadline;
+
+	if (deadlineTicks == std::chrono::steady_clock::duration::max().count())
+		return false;
+
+	if (std::chrono::steady_clock::now().time_since_epoch().count() < deadlineTicks)
+		return false;
+
+	cancelled = true;
+
+	return true;
+}
\ No newline at end of file
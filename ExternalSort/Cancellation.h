@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  Cancellation.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the CancelToken class, which lets a caller stop a sort before it
+//                  finishes. The caller gives the sort a token through its options, and cancels it from
+//                  any thread or signal handler, or gives it a deadline. The stages of the sort check
+//                  the token each time they start on a new block, and once it is cancelled they stop,
+//                  remove their temp files and any partly written output, and return. A sort that was
+//                  stopped returns false, so the caller need not check the token again afterwards.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+
+class CancelToken
+{
+public:
+	CancelToken();
+
+	void cancel();
+	void setDeadline(double);
+	bool isCancelled();
+
+private:
+	// Set once the token has been cancelled or its deadline has passed
+	std::atomic<bool> cancelled;
+
+	// The time on the steady clock, in its ticks, at which the token cancels itself, or the largest
+	// number of ticks if it has no deadline
+	std::atomic<std::chrono::steady_clock::rep> deadline;
+};
+
+#endif
\ No newline at end of file
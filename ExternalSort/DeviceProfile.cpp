@@ -0,0 +1,428 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    DeviceProfile.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains functions for measuring the read performance of the device that
+//                    holds the temp directory, saving and loading those measurements, and choosing the
+//                    merge fan-in and buffer size that make the best use of the device.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+#include "DeviceProfile.h"
+
+// The name of the file in a temp directory that its device profile is saved in
+static const char* PROFILE_FILE_NAME = "ExternalSort.profile";
+
+// The name of the file that is written to a temp directory and read back to measure its device. The ID
+// of the process is added to it, so that sorts sharing a temp directory each measure their own file.
+static const char* CALIBRATION_FILE_NAME = "ExternalSort.calibration";
+
+// The size of the calibration file, and the sizes of the sequential and random reads made from it
+static const int CALIBRATION_FILE_BYTES = 32 * 1024 * 1024;
+static const int SEQUENTIAL_READ_BYTES = 1024 * 1024;
+static const int RANDOM_READ_BYTES = 4096;
+
+// The number of random reads made from the calibration file
+static const int NUM_RANDOM_READS = 64;
+
+static std::string pathInDirectory(const std::string&, const char*);
+static void dropCachedPages(const std::string&);
+static int currentProcessId();
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  loadDeviceProfile
+//
+//        Purpose:  Loads the device profile saved in a temp directory. The profile is a text file of
+//                  name and value pairs, so the fanIn and bufferInts values in it can be edited by hand
+//                  to override the merge shape for that temp directory.
+//
+//      Parameter:  tempDirectory is the temp directory, or an empty string for the current directory.
+//
+//      Parameter:  profile receives the loaded profile.
+//
+//        Returns:  True if a profile was loaded, or false if the temp directory does not have one.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool loadDeviceProfile(const std::string& tempDirectory, DeviceProfile& profile)
+{
+	std::ifstream profileFile(pathInDirectory(tempDirectory, PROFILE_FILE_NAME));
+
+	if (!profileFile.is_open())
+		return false;
+
+	profile.seekSeconds = 0;
+	profile.bytesPerSecond = 0;
+	profile.fanIn = 0;
+	profile.bufferInts = 0;
+
+	std::string name;
+
+	while (profileFile >> name)
+	{
+		if (name == "seekSeconds")
+			profileFile >> profile.seekSeconds;
+		else if (name == "bytesPerSecond")
+			profileFile >> profile.bytesPerSecond;
+		else if (name == "fanIn")
+			profileFile >> profile.fanIn;
+		else if (name == "bufferInts")
+			profileFile >> profile.bufferInts;
+	}
+
+	return profile.bytesPerSecond > 0 || profile.fanIn > 0 || profile.bufferInts > 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  saveDeviceProfile
+//
+//        Purpose:  Saves a device profile in a temp directory so that the device does not have to be
+//                  measured again the next time a file is sorted there.
+//
+//      Parameter:  tempDirectory is the temp directory, or an empty string for the current directory.
+//
+//      Parameter:  profile is the profile to save.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void saveDeviceProfile(const std::string& tempDirectory, const DeviceProfile& profile)
+{
+	std::ofstream profileFile(pathInDirectory(tempDirectory, PROFILE_FILE_NAME));
+
+	profileFile << "seekSeconds " << profile.seekSeconds << std::endl;
+	profileFile << "bytesPerSecond " << profile.bytesPerSecond << std::endl;
+	profileFile << "fanIn " << profile.fanIn << std::endl;
+	profileFile << "bufferInts " << profile.bufferInts << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  calibrateDevice
+//
+//        Purpose:  Measures the device that holds a temp directory by writing a calibration file to it,
+//                  then timing one sequential pass over the file followed by reads of small blocks at
+//                  random offsets. The time a random read takes beyond transferring its data is the
+//                  device's seek cost.
+//
+//      Parameter:  tempDirectory is the temp directory, or an empty string for the current directory.
+//
+//        Returns:  The measured profile, with no fan-in or buffer size override. If the calibration file
+//                  could not be written or read back, the device is not measured, and the profile has a
+//                  transfer rate of 0.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+DeviceProfile calibrateDevice(const std::string& tempDirectory)
+{
+	DeviceProfile profile;
+
+	profile.seekSeconds = 0;
+	profile.bytesPerSecond = 0;
+	profile.fanIn = 0;
+	profile.bufferInts = 0;
+
+	std::string calibrationPath = pathInDirectory(tempDirectory, CALIBRATION_FILE_NAME) + "." + std::to_string(currentProcessId());
+
+	std::vector<char> block(SEQUENTIAL_READ_BYTES, 1);
+
+	// Write the calibration file, and make sure it is read back from the device rather than from memory
+	std::ofstream outFile(calibrationPath, std::ios::out | std::ios::binary);
+
+	for (int written = 0; written < CALIBRATION_FILE_BYTES; written += SEQUENTIAL_READ_BYTES)
+		outFile.write(block.data(), SEQUENTIAL_READ_BYTES);
+
+	outFile.close();
+
+	// A device that is full or read-only cannot be measured, and what was written of the file is removed
+	if (outFile.fail())
+	{
+		remove(calibrationPath.c_str());
+
+		return profile;
+	}
+
+	dropCachedPages(calibrationPath);
+
+	std::ifstream inFile(calibrationPath, std::ios::in | std::ios::binary);
+
+	if (!inFile.is_open())
+	{
+		remove(calibrationPath.c_str());
+
+		return profile;
+	}
+
+	// Time reading the whole file sequentially
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int read = 0; read < CALIBRATION_FILE_BYTES; read += SEQUENTIAL_READ_BYTES)
+		inFile.read(block.data(), SEQUENTIAL_READ_BYTES);
+
+	std::chrono::duration<double> sequentialTime = std::chrono::steady_clock::now() - start;
+
+	dropCachedPages(calibrationPath);
+
+	// Time reading small blocks from random offsets in the file
+	std::mt19937 generator(CALIBRATION_FILE_BYTES);
+
+	std::uniform_int_distribution<int> blockIndex(0, CALIBRATION_FILE_BYTES / RANDOM_READ_BYTES - 1);
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < NUM_RANDOM_READS; i++)
+	{
+		inFile.clear();
+
+		inFile.seekg((std::streamoff)blockIndex(generator) * RANDOM_READ_BYTES);
+
+		inFile.read(block.data(), RANDOM_READ_BYTES);
+	}
+
+	std::chrono::duration<double> randomTime = std::chrono::steady_clock::now() - start;
+
+	inFile.close();
+
+	remove(calibrationPath.c_str());
+
+	// Avoid dividing by zero if the reads were too fast for the clock to measure
+	profile.bytesPerSecond = CALIBRATION_FILE_BYTES / ((sequentialTime.count() > 0) ? sequentialTime.count() : 1e-9);
+
+	profile.seekSeconds = randomTime.count() / NUM_RANDOM_READS - RANDOM_READ_BYTES / profile.bytesPerSecond;
+
+	if (profile.seekSeconds < 0)
+		profile.seekSeconds = 0;
+
+	return profile;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  chooseMergeShape
+//
+//        Purpose:  Chooses the fan-in and the number of ints buffered per file for merging temp files,
+//                  using the device profile of the temp directory. The device is measured and its profile
+//                  saved if the temp directory does not have one yet. A high fan-in means fewer passes
+//                  over the data, but smaller buffers and so more seeks per pass. Every fan-in is tried,
+//                  and the one with the lowest estimated total read time is chosen. Besides one buffer
+//                  per file, PREFETCH_BUFFERS spare buffers are set aside for reading ahead and
+//                  OUTPUT_BUFFERS buffers for writing behind as long as the memory limit allows it.
+//
+//      Parameter:  options holds the memory limit and temp directory, and receives the fan-in, buffer
+//                  size, and number of prefetch and output buffers.
+//
+//      Parameter:  numFiles is the number of temp files that need to be merged.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void chooseMergeShape(SortOptions& options, int numFiles)
+{
+	// One spare buffer can be filled while another waits to be used, so two are enough to keep the
+	// background reads ahead of the merge
+	const int PREFETCH_BUFFERS = 2;
+
+	// Likewise, one output buffer can be written while the merge fills the other
+	const int OUTPUT_BUFFERS = 2;
+
+	bool roomForExtraBuffers = options.maxFileInts >= 2 + PREFETCH_BUFFERS + OUTPUT_BUFFERS;
+
+	options.prefetchBuffers = roomForExtraBuffers ? PREFETCH_BUFFERS : 0;
+
+	options.outputBuffers = roomForExtraBuffers ? OUTPUT_BUFFERS : 0;
+
+	int numExtraBuffers = options.prefetchBuffers + options.outputBuffers;
+
+	// Each buffer needs at least one int in memory, so at most maxFileInts files, less the extra
+	// buffers, can be merged at once, and there is no point merging more files than there are
+	int maxFanIn = options.maxFileInts - numExtraBuffers;
+
+	if (numFiles < maxFanIn)
+		maxFanIn = numFiles;
+
+	if (maxFanIn < 2)
+		maxFanIn = 2;
+
+	options.fanIn = maxFanIn;
+
+	options.bufferInts = options.maxFileInts / (options.fanIn + numExtraBuffers);
+
+	// A single temp file does not need to be merged, so the device does not need to be measured
+	if (numFiles < 2)
+		return;
+
+	DeviceProfile profile;
+
+	if (!loadDeviceProfile(options.tempDirectory, profile))
+	{
+		profile = calibrateDevice(options.tempDirectory);
+
+		// A device that could not be measured is tried again by the next sort
+		if (profile.bytesPerSecond > 0)
+			saveDeviceProfile(options.tempDirectory, profile);
+	}
+
+	if (profile.bytesPerSecond > 0)
+	{
+		double bestTime = 0;
+
+		for (int fanIn = 2; fanIn <= maxFanIn; fanIn++)
+		{
+			int bufferInts = options.maxFileInts / (fanIn + numExtraBuffers);
+
+			int numPasses = countMergePasses(numFiles, fanIn);
+
+			// Each buffer refill costs a seek plus the time to transfer the buffer
+			double bufferBytes = (double)bufferInts * sizeof(int);
+
+			double timePerByte = (profile.seekSeconds + bufferBytes / profile.bytesPerSecond) / bufferBytes;
+
+			double time = numPasses * timePerByte;
+
+			if (fanIn == 2 || time < bestTime)
+			{
+				bestTime = time;
+
+				options.fanIn = fanIn;
+
+				options.bufferInts = bufferInts;
+			}
+		}
+	}
+
+	// Apply any overrides from the profile, keeping the merge within the memory limit
+	if (profile.fanIn > 0)
+	{
+		options.fanIn = (profile.fanIn < options.maxFileInts) ? profile.fanIn : options.maxFileInts;
+
+		if (options.fanIn < 2)
+			options.fanIn = 2;
+
+		if (options.fanIn + numExtraBuffers > options.maxFileInts)
+		{
+			options.prefetchBuffers = 0;
+
+			options.outputBuffers = 0;
+
+			numExtraBuffers = 0;
+		}
+
+		options.bufferInts = options.maxFileInts / (options.fanIn + numExtraBuffers);
+	}
+
+	if (profile.bufferInts > 0)
+		options.bufferInts = profile.bufferInts;
+
+	if ((long long)(options.fanIn + numExtraBuffers) * options.bufferInts > options.maxFileInts)
+		options.bufferInts = options.maxFileInts / (options.fanIn + numExtraBuffers);
+
+	if (options.bufferInts < 1)
+		options.bufferInts = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  countMergePasses
+//
+//        Purpose:  Counts the passes over the data needed to merge files with a fan-in.
+//
+//      Parameter:  numFiles is the number of files to merge.
+//
+//      Parameter:  fanIn is the maximum number of files merged at one time.
+//
+//        Returns:  The number of passes, which is 0 for a single file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int countMergePasses(int numFiles, int fanIn)
+{
+	int numPasses = 0;
+
+	for (double filesPerOutput = 1; filesPerOutput < numFiles; filesPerOutput *= fanIn)
+		numPasses++;
+
+	return numPasses;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  pathInDirectory
+//
+//        Purpose:  Builds the path of a file in a directory.
+//
+//      Parameter:  directory is the directory, or an empty string for the current directory.
+//
+//      Parameter:  fileName is the name of the file.
+//
+//        Returns:  The path of the file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string pathInDirectory(const std::string& directory, const char* fileName)
+{
+	return directory.empty() ? std::string(fileName) : directory + "/" + fileName;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  dropCachedPages
+//
+//        Purpose:  Asks the operating system to forget any cached pages of a file, so that the next read
+//                  of it goes to the device. This is only supported on Linux. On other systems the
+//                  calibration measures reads from the cache, which makes the device look like it has no
+//                  seek cost, so an override should be put in the profile of any temp directory on a
+//                  spinning disk.
+//
+//      Parameter:  path is the path of the file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void dropCachedPages(const std::string& path)
+{
+#ifdef __linux__
+	int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd >= 0)
+	{
+		fdatasync(fd);
+
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+		close(fd);
+	}
+#else
+	(void)path;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  currentProcessId
+//
+//        Purpose:  Gets the ID of this process, which no other running process shares.
+//
+//        Returns:  The ID of the process.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int currentProcessId()
+{
+#ifdef _WIN32
+	return _getpid();
+#else
+	return (int)getpid();
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  DeviceProfile.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the DeviceProfile struct declaration, which describes how quickly
+//                  the device holding the temp directory reads data sequentially and how long it takes
+//                  to seek, along with the functions that measure it and use it to choose how many files
+//                  are merged at one time.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEVICEPROFILE_H
+#define DEVICEPROFILE_H
+
+#include <string>
+
+#include "SortOptions.h"
+
+// Read performance of the device that holds a temp directory
+struct DeviceProfile
+{
+	// The time spent on a random read beyond the time it takes to transfer the data
+	double seekSeconds;
+
+	// The number of bytes per second that can be read sequentially
+	double bytesPerSecond;
+
+	// The fan-in to use for this temp directory instead of the one chosen from the measurements, or 0
+	int fanIn;
+
+	// The number of ints to buffer per file for this temp directory instead of the number chosen from
+	// the measurements, or 0
+	int bufferInts;
+};
+
+bool loadDeviceProfile(const std::string&, DeviceProfile&);
+void saveDeviceProfile(const std::string&, const DeviceProfile&);
+DeviceProfile calibrateDevice(const std::string&);
+void chooseMergeShape(SortOptions&, int);
+int countMergePasses(int, int);
+
+#endif
\ No newline at end of file
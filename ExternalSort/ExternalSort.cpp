@@ -0,0 +1,292 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    ExternalSort.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the functions for performing external sort on a binary file that
+//                    do not depend on the order the ints are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ExternalSort.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  startChunkRead
+//
+//        Purpose:  Starts reading the next ints of the unsorted file into a chunk, once the chunk's last
+//                  write is finished.
+//
+//      Parameter:  unsortedFile is an ifstream object that has already opened the file to sort.
+//
+//      Parameter:  chunk is the chunk to read into.
+//
+//      Parameter:  chunkInts is the number of ints each chunk holds.
+//
+//      Parameter:  amountLeftToRead is the number of ints in the unsorted file that have not been read,
+//                  and is updated to account for this read.
+//
+//      Parameter:  numReadsStarted is the number of chunk reads started so far, and is updated to
+//                  account for this read.
+//
+//      Parameter:  io is the backend that carries out the read.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void startChunkRead(std::ifstream& unsortedFile, SortChunk& chunk, int chunkInts, long long& amountLeftToRead, int& numReadsStarted, IoBackend& io)
+{
+	if (amountLeftToRead <= 0)
+		return;
+
+	io.await(chunk.request);
+
+	// If the number of integers left to read in the unsorted file is less than the size of a chunk,
+	// then read only that amount
+	chunk.count = (amountLeftToRead < chunkInts) ? (int)amountLeftToRead : chunkInts;
+
+	amountLeftToRead -= chunk.count;
+
+	io.readBlock(chunk.request, unsortedFile, chunk.values, sizeof(int) * chunk.count);
+
+	numReadsStarted++;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  reportOvcCounters
+//
+//        Purpose:  Prints how many merge matches offset-value coding decided without comparing full keys,
+//                  if the merges used it.
+//
+//      Parameter:  options holds whether the merges used offset-value coding.
+//
+//      Parameter:  ovcCounters holds the number of matches decided by codes and by full keys.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void reportOvcCounters(const SortOptions& options, const OvcCounters& ovcCounters)
+{
+	if (!options.offsetValueCoding)
+		return;
+
+	long long numMatches = ovcCounters.codeDecisions + ovcCounters.fullComparisons;
+
+	std::cout << "Offset-value coding decided " << ovcCounters.codeDecisions << " of " << numMatches
+		<< " merge matches without comparing full keys." << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  reportSelfCheck
+//
+//        Purpose:  Prints whether the output of a sort holds the same ints as its input, if the sort was
+//                  asked to check its output.
+//
+//      Parameter:  options holds whether the sort checks its output.
+//
+//      Parameter:  inputHash is the multiset hash of the input.
+//
+//      Parameter:  outputHash is the multiset hash of the output.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void reportSelfCheck(const SortOptions& options, unsigned long long inputHash, unsigned long long outputHash)
+{
+	if (!options.selfCheck)
+		return;
+
+	if (inputHash == outputHash)
+		std::cout << "Self-check passed: the output holds the same ints as the input." << std::endl;
+	else
+		std::cout << "Self-check FAILED: the output does not hold the same ints as the input." << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  tempFilePath
+//
+//        Purpose:  Builds the path of a numbered temp file.
+//
+//      Parameter:  options holds the directory that temp files are written to, and the prefix of their
+//                  names.
+//
+//      Parameter:  fileNumber is the number of the temp file.
+//
+//        Returns:  The path of the temp file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string tempFilePath(const SortOptions& options, int fileNumber)
+{
+	if (options.tempDirectory.empty())
+		return options.tempPrefix + std::to_string(fileNumber);
+
+	return options.tempDirectory + "/" + options.tempPrefix + std::to_string(fileNumber);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sortCancelled
+//
+//        Purpose:  Checks whether a sort has been cancelled.
+//
+//      Parameter:  options holds the token that cancels the sort, if it has one.
+//
+//        Returns:  True if the sort has a token and it has been cancelled or its deadline has passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool sortCancelled(const SortOptions& options)
+{
+	return options.cancel != nullptr && options.cancel->isCancelled();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  removeTempFiles
+//
+//        Purpose:  Deletes a range of numbered temp files, such as the ones left when a sort is cancelled.
+//
+//      Parameter:  options holds the directory that the temp files are in, and the prefix of their names.
+//
+//      Parameter:  first is the number of the first temp file to delete.
+//
+//      Parameter:  end is the number after the last temp file to delete.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void removeTempFiles(const SortOptions& options, int first, int end)
+{
+	for (int i = first; i < end; i++)
+		remove(tempFilePath(options, i).c_str());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  removeFiles
+//
+//        Purpose:  Deletes files, such as the runs a cancelled sort left for another operator.
+//
+//      Parameter:  paths holds the paths of the files.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void removeFiles(const std::vector<std::string>& paths)
+{
+	for (int i = 0; i < (int)paths.size(); i++)
+		remove(paths[i].c_str());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  removeOutput
+//
+//        Purpose:  Deletes an output file that a cancelled sort only partly wrote, along with its index
+//                  if the sort was building one.
+//
+//      Parameter:  path is the path of the output file.
+//
+//      Parameter:  options holds whether the output is indexed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void removeOutput(const std::string& path, const SortOptions& options)
+{
+	remove(path.c_str());
+
+	if (options.indexInterval > 0)
+		remove(indexFilePath(path).c_str());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  moveFile
+//
+//        Purpose:  Moves a file to a new path, replacing any file already there. The file is renamed if
+//                  possible. If it cannot be renamed, which happens when the temp directory is on a
+//                  different device than the new path, or on Windows when the new path already exists,
+//                  it is copied next to the new path first. The file at the new path is only replaced
+//                  once the copy has been written in full, so a failed move leaves both files as they
+//                  were.
+//
+//      Parameter:  fromPath is the current path of the file.
+//
+//      Parameter:  toPath is the path to move the file to.
+//
+//        Returns:  True if the file was moved.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool moveFile(const std::string& fromPath, const std::string& toPath)
+{
+	if (rename(fromPath.c_str(), toPath.c_str()) == 0)
+		return true;
+
+	std::ifstream fromFile(fromPath, std::ios::in | std::ios::binary);
+
+	if (!fromFile.is_open())
+		return false;
+
+	std::string copyPath = toPath + ".part";
+
+	std::ofstream toFile(copyPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!toFile.is_open())
+		return false;
+
+	// Inserting an empty buffer counts as a failure, so an empty file is not copied at all
+	if (fromFile.peek() != std::ifstream::traits_type::eof())
+		toFile << fromFile.rdbuf();
+
+	fromFile.close();
+
+	toFile.close();
+
+	if (toFile.fail())
+	{
+		remove(copyPath.c_str());
+
+		return false;
+	}
+
+	remove(toPath.c_str());
+
+	if (rename(copyPath.c_str(), toPath.c_str()) != 0)
+	{
+		remove(copyPath.c_str());
+
+		return false;
+	}
+
+	remove(fromPath.c_str());
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  fileLen
+//
+//        Purpose:  Determines the length in bytes of an input file.
+//
+//      Parameter:  file is an ifstream object with the file to determine the length of already open.
+//
+//        Returns:  The length of the file in bytes, which may be more than an int can hold.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+long long fileLen(std::ifstream& file)
+{
+	long long position = file.tellg();
+
+	file.seekg(0, std::ios::beg);
+
+	long long start = file.tellg();
+
+	file.seekg(0, std::ios::end);
+
+	long long end = file.tellg();
+
+	file.clear();
+
+	file.seekg(position);
+
+	return end - start;
+}
\ No newline at end of file
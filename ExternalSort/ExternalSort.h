@@ -0,0 +1,1187 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  ExternalSort.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the functions for performing external sort on a binary file. The
+//                  functions that compare ints are templates on an order policy from SortOrder.h, so
+//                  the same sort can be instantiated for any order without any cost per comparison.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#include "AsyncIo.h"
+#include "DeviceProfile.h"
+#include "FileInteger.h"
+#include "IndexedFile.h"
+#include "LoserTree.h"
+#include "MemoryPressure.h"
+#include "MergeJoin.h"
+#include "MergeStream.h"
+#include "OutputWriter.h"
+#include "OvcLoserTree.h"
+#include "Prefetcher.h"
+#include "RadixSort.h"
+#include "SetOperations.h"
+#include "SortChunk.h"
+#include "SortOptions.h"
+#include "SortOrder.h"
+#include "Verify.h"
+
+template <class Order> bool sortFile(std::ifstream&, std::string&, SortOptions&, IoBackend&, const Order& = Order());
+template <class Order> bool joinFiles(const std::string&, const std::string&, const std::string&, JoinType, int, const SortOptions&, IoBackend&, const Order&);
+template <class Order> bool combineFiles(const std::vector<std::string>&, const std::string&, SetOperation, bool, const SortOptions&, IoBackend&, const Order&);
+template <class Order> bool mergeFiles(const std::vector<std::string>&, const std::string&, SortOptions&, IoBackend&, const Order&);
+template <class Order> bool updateSortedFile(const std::string&, const std::string&, const std::string&, const SortOptions&, IoBackend&, const Order&);
+template <class Order> std::vector<std::string> sortIntoRuns(const std::string&, SortOptions&, int, IoBackend&, const Order&);
+template <class Order> int makeTempFiles(std::ifstream&, const SortOptions&, IoBackend&, const Order&, unsigned long long&);
+template <class Order> void sortRun(int*, int, bool, const Order&, std::true_type);
+template <class Order> void sortRun(int*, int, bool, const Order&, std::false_type);
+void startChunkRead(std::ifstream&, SortChunk&, int, long long&, int&, IoBackend&);
+template <class Order> unsigned long long mergeTempFiles(int, SortOptions&, std::string&, IoBackend&, const Order&);
+template <class Order> std::vector<std::string> reduceTempFiles(int, SortOptions&, IoBackend&, const Order&, OvcCounters&);
+template <class Order> unsigned long long mergeRuns(const std::vector<std::string>&, bool, const std::string&, const SortOptions&, IoBackend&, const Order&, OvcCounters&, std::true_type);
+template <class Order> unsigned long long mergeRuns(const std::vector<std::string>&, bool, const std::string&, const SortOptions&, IoBackend&, const Order&, OvcCounters&, std::false_type);
+template <class Stream> unsigned long long writeStream(Stream&, const std::string&, const SortOptions&, IoBackend&);
+std::string tempFilePath(const SortOptions&, int);
+void reportOvcCounters(const SortOptions&, const OvcCounters&);
+void reportSelfCheck(const SortOptions&, unsigned long long, unsigned long long);
+bool sortCancelled(const SortOptions&);
+void removeTempFiles(const SortOptions&, int, int);
+void removeFiles(const std::vector<std::string>&);
+void removeOutput(const std::string&, const SortOptions&);
+bool moveFile(const std::string&, const std::string&);
+long long fileLen(std::ifstream&);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sortFile
+//
+//        Purpose:  Sorts a file by splitting it into sorted temp files, choosing how to merge them based
+//                  on the temp device, and merging them into the sorted file.
+//
+//      Parameter:  unsortedFile is an ifstream object that has already opened the file to sort.
+//
+//      Parameter:  sortedPath will be the path/name of the file once it is sorted.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, whether the sort is stable, how often the sorted
+//                  file is indexed, whether the sort checks its output, and the tracker to report its
+//                  progress to and the token that cancels it, if any. The fan-in and buffer sizes of the
+//                  merge are filled in by this function. If the sort is cancelled, it removes its temp
+//                  files and the partly written sorted file.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//        Returns:  True if the operation finished, or false if it was cancelled, in which case its temp
+//                  files and output have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool sortFile(std::ifstream& unsortedFile, std::string& sortedPath, SortOptions& options, IoBackend& io, const Order& order)
+{
+	// The hash of the unsorted file, taken while its chunks are in memory to be sorted
+	unsigned long long inputHash = 0;
+
+	if (options.progress)
+		options.progress->start(fileLen(unsortedFile), 1);
+
+	int numberOfFiles = makeTempFiles(unsortedFile, options, io, order, inputHash);
+
+	if (sortCancelled(options))
+	{
+		removeTempFiles(options, 0, numberOfFiles);
+
+		return false;
+	}
+
+	chooseMergeShape(options, numberOfFiles);
+
+	if (options.progress)
+		options.progress->expectPasses(1 + countMergePasses(numberOfFiles, options.fanIn));
+
+	unsigned long long outputHash = mergeTempFiles(numberOfFiles, options, sortedPath, io, order);
+
+	// The sorted file may have been finished just as the sort was cancelled, but a cancelled sort
+	// leaves nothing behind
+	if (sortCancelled(options))
+	{
+		removeOutput(sortedPath, options);
+
+		return false;
+	}
+
+	if (options.progress)
+		options.progress->finish();
+
+	reportSelfCheck(options, inputHash, outputHash);
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  joinFiles
+//
+//        Purpose:  Sorts two files and joins them. Each file is sorted into runs until few enough remain
+//                  to be merged at one time, and the final merges of both files are piped straight into
+//                  the join, so neither sorted file is ever written. The memory limit is split between the
+//                  two final merges.
+//
+//      Parameter:  leftPath is the path of the left file.
+//
+//      Parameter:  rightPath is the path of the right file.
+//
+//      Parameter:  joinedPath is the path of the file to write the joined ints to.
+//
+//      Parameter:  type is the kind of join.
+//
+//      Parameter:  nullValue is the int written in place of the right int of an unmatched left int in a
+//                  left join.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, and the token that cancels the operation, if
+//                  any. A cancelled operation removes its temp files and output.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the files in. Ints match if neither comes before the other.
+//
+//        Returns:  True if the operation finished, or false if it was cancelled, in which case its temp
+//                  files and output have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool joinFiles(const std::string& leftPath, const std::string& rightPath, const std::string& joinedPath, JoinType type, int nullValue, const SortOptions& options, IoBackend& io, const Order& order)
+{
+	SortOptions leftOptions = options;
+
+	leftOptions.tempPrefix = options.tempPrefix + "left-";
+
+	SortOptions rightOptions = options;
+
+	rightOptions.tempPrefix = options.tempPrefix + "right-";
+
+	std::vector<std::string> leftRuns = sortIntoRuns(leftPath, leftOptions, options.maxFileInts / 2, io, order);
+
+	std::vector<std::string> rightRuns = sortIntoRuns(rightPath, rightOptions, options.maxFileInts / 2, io, order);
+
+	if (sortCancelled(options))
+	{
+		removeFiles(leftRuns);
+
+		removeFiles(rightRuns);
+
+		return false;
+	}
+
+	MergeStream<Order> left(leftRuns, true, leftOptions, io, order);
+
+	MergeStream<Order> right(rightRuns, true, rightOptions, io, order);
+
+	// The output buffers are taken from the left merge's share of memory
+	OutputWriter output(joinedPath, leftOptions.outputBuffers, leftOptions.bufferInts, io);
+
+	mergeJoin(left, right, type, nullValue, output, order);
+
+	output.close();
+
+	// A cancelled merge hands out no more ints, so the join stops early and its output is incomplete
+	if (sortCancelled(options))
+	{
+		removeOutput(joinedPath, options);
+
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  combineFiles
+//
+//        Purpose:  Combines files of ints with a set operation. Unless the files are already sorted, each
+//                  is sorted into runs until few enough remain to be merged at one time, and the final
+//                  merges of all the files are piped straight into the set operation. The memory limit is
+//                  split evenly between the final merges.
+//
+//      Parameter:  inputPaths holds the paths of the files. For a difference, the first file is the one
+//                  the others are subtracted from.
+//
+//      Parameter:  combinedPath is the path of the file to write the result to.
+//
+//      Parameter:  operation is the set operation.
+//
+//      Parameter:  presorted is true if every file is already sorted in the order, so it can be read
+//                  directly instead of being sorted first. The program exits if one is not sorted.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, and the token that cancels the operation, if
+//                  any. A cancelled operation removes its temp files and output.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the files in. Ints are the same member of a set if neither
+//                  comes before the other.
+//
+//        Returns:  True if the operation finished, or false if it was cancelled, in which case its temp
+//                  files and output have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool combineFiles(const std::vector<std::string>& inputPaths, const std::string& combinedPath, SetOperation operation, bool presorted, const SortOptions& options, IoBackend& io, const Order& order)
+{
+	int numInputs = (int)inputPaths.size();
+
+	int maxMergeInts = options.maxFileInts / numInputs;
+
+	if (maxMergeInts <= 1)
+	{
+		std::cout << "Must allow more than one int in memory simultaneously for each input file." << std::endl;
+		exit(0);
+	}
+
+	std::vector<SortOptions> inputOptions(numInputs, options);
+
+	std::vector<std::vector<std::string>> inputRuns(numInputs);
+
+	for (int i = 0; i < numInputs; i++)
+	{
+		inputOptions[i].tempPrefix = options.tempPrefix + std::to_string(i) + "-";
+
+		if (!presorted)
+		{
+			inputRuns[i] = sortIntoRuns(inputPaths[i], inputOptions[i], maxMergeInts, io, order);
+
+			continue;
+		}
+
+		if (verifyFile(inputPaths[i], options.maxFileInts, true, order).firstUnsorted >= 0)
+		{
+			std::cout << "Input file " << inputPaths[i] << " is not sorted." << std::endl;
+			exit(0);
+		}
+
+		// A sorted file is read as a single run, which is kept once it has been read
+		inputRuns[i].push_back(inputPaths[i]);
+
+		inputOptions[i].maxFileInts = maxMergeInts;
+
+		chooseMergeShape(inputOptions[i], 1);
+	}
+
+	// Runs are only removed if they are temp files, and not the sorted input files
+	if (sortCancelled(options))
+	{
+		for (int i = 0; i < numInputs && !presorted; i++)
+			removeFiles(inputRuns[i]);
+
+		return false;
+	}
+
+	std::vector<MergeStream<Order>*> streams;
+
+	for (int i = 0; i < numInputs; i++)
+		streams.push_back(new MergeStream<Order>(inputRuns[i], !presorted, inputOptions[i], io, order));
+
+	// The output buffers are taken from the first file's share of memory
+	OutputWriter output(combinedPath, inputOptions[0].outputBuffers, inputOptions[0].bufferInts, io);
+
+	if (options.indexInterval > 0)
+		output.buildIndex(indexFilePath(combinedPath), options.indexInterval);
+
+	applySetOperation(streams, operation, output, order);
+
+	output.close();
+
+	for (int i = 0; i < numInputs; i++)
+		delete streams[i];
+
+	if (sortCancelled(options))
+	{
+		removeOutput(combinedPath, options);
+
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeFiles
+//
+//        Purpose:  Merges files that are each already sorted into one sorted file, without sorting them
+//                  again. Every file is checked to be sorted first. The files are then the initial runs of
+//                  the merge: if there are more than the fan-in, groups of them are merged into temp
+//                  files, which are merged like the temp files of a sort. The files themselves are kept.
+//
+//      Parameter:  inputPaths holds the paths of the sorted files. In stable mode, ints that compare
+//                  equal keep the order of the files they came from.
+//
+//      Parameter:  mergedPath is the path of the file to write the merged ints to.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, whether the merge is stable, whether the
+//                  merged file is checked against the files, and the tracker to report its progress to
+//                  and the token that cancels it, if any. The fan-in and buffer sizes of the merge are
+//                  filled in by this function. A cancelled merge removes its temp files and output.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order the files are sorted in. The program exits if one is not.
+//
+//        Returns:  True if the operation finished, or false if it was cancelled, in which case its temp
+//                  files and output have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool mergeFiles(const std::vector<std::string>& inputPaths, const std::string& mergedPath, SortOptions& options, IoBackend& io, const Order& order)
+{
+	// Checking the files also gives the hash of their ints, and their size
+	unsigned long long inputHash = 0;
+
+	long long numInputInts = 0;
+
+	for (int i = 0; i < (int)inputPaths.size(); i++)
+	{
+		VerifyResult input = verifyFile(inputPaths[i], options.maxFileInts, true, order);
+
+		if (input.firstUnsorted >= 0)
+		{
+			std::cout << "Input file " << inputPaths[i] << " is not sorted." << std::endl;
+			exit(0);
+		}
+
+		inputHash += input.hash;
+
+		numInputInts += input.numInts;
+
+		if (sortCancelled(options))
+			return false;
+	}
+
+	chooseMergeShape(options, (int)inputPaths.size());
+
+	if (options.progress)
+		options.progress->start(numInputInts * sizeof(int), countMergePasses((int)inputPaths.size(), options.fanIn));
+
+	OvcCounters ovcCounters;
+
+	ovcCounters.codeDecisions = 0;
+
+	ovcCounters.fullComparisons = 0;
+
+	if ((int)inputPaths.size() <= options.fanIn)
+	{
+		if (options.progress)
+			options.progress->beginPass("merge");
+
+		unsigned long long outputHash = mergeRuns(inputPaths, false, mergedPath, options, io, order, ovcCounters, std::integral_constant<bool, HasNormalizedKey<Order>::value>());
+
+		if (sortCancelled(options))
+		{
+			removeOutput(mergedPath, options);
+
+			return false;
+		}
+
+		if (options.progress)
+			options.progress->finish();
+
+		reportOvcCounters(options, ovcCounters);
+
+		reportSelfCheck(options, inputHash, outputHash);
+
+		return true;
+	}
+
+	// The first pass merges groups of the files into temp files numbered in the order of the files
+	int numberOfFiles = 0;
+
+	if (options.progress)
+		options.progress->beginPass("merge");
+
+	for (int first = 0; first < (int)inputPaths.size(); numberOfFiles++)
+	{
+		adaptToMemoryPressure(options, (int)inputPaths.size() - first);
+
+		int last = first + options.fanIn < (int)inputPaths.size() ? first + options.fanIn : (int)inputPaths.size();
+
+		std::vector<std::string> group(inputPaths.begin() + first, inputPaths.begin() + last);
+
+		// Only the final merge writes an index or is checked
+		SortOptions passOptions = options;
+
+		passOptions.indexInterval = 0;
+
+		passOptions.selfCheck = false;
+
+		mergeRuns(group, false, tempFilePath(options, numberOfFiles), passOptions, io, order, ovcCounters, std::integral_constant<bool, HasNormalizedKey<Order>::value>());
+
+		first = last;
+
+		// The input files are kept, so only the temp files merged from them so far are removed
+		if (sortCancelled(options))
+		{
+			removeTempFiles(options, 0, numberOfFiles + 1);
+
+			return false;
+		}
+	}
+
+	std::string finalPath = mergedPath;
+
+	unsigned long long outputHash = mergeTempFiles(numberOfFiles, options, finalPath, io, order);
+
+	if (sortCancelled(options))
+	{
+		removeOutput(mergedPath, options);
+
+		return false;
+	}
+
+	if (options.progress)
+		options.progress->finish();
+
+	if (options.offsetValueCoding)
+		std::cout << "The first pass over the input files is not included in the count above." << std::endl;
+
+	reportSelfCheck(options, inputHash, outputHash);
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  updateSortedFile
+//
+//        Purpose:  Merges an unsorted delta into a sorted base file. Only the delta is sorted into runs,
+//                  and its final merge is merged with the base as the base is read. The stretches of the
+//                  base between two delta ints are found with a binary search of the base's block, and
+//                  copied to the output at once. A block that comes entirely before the next delta int
+//                  is copied without comparing any of its ints, so the comparisons grow with the size of
+//                  the delta rather than the base. Base ints come before delta ints equal to them.
+//
+//      Parameter:  basePath is the path of the sorted base file. It is not checked to be sorted, since
+//                  that would take a comparison per int of the base.
+//
+//      Parameter:  deltaPath is the path of the unsorted delta file.
+//
+//      Parameter:  updatedPath is the path of the file to write the merged ints to. It must not be the
+//                  base file.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, whether the delta is sorted stably, and the
+//                  token that cancels the update, if any. A cancelled update removes its temp files and
+//                  output.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order the base file is sorted in.
+//
+//        Returns:  True if the operation finished, or false if it was cancelled, in which case its temp
+//                  files and output have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool updateSortedFile(const std::string& basePath, const std::string& deltaPath, const std::string& updatedPath, const SortOptions& options, IoBackend& io, const Order& order)
+{
+	// The memory limit is split between the delta's final merge and the base's buffers
+	SortOptions deltaOptions = options;
+
+	deltaOptions.tempPrefix = options.tempPrefix + "delta-";
+
+	std::vector<std::string> deltaRuns = sortIntoRuns(deltaPath, deltaOptions, options.maxFileInts / 2, io, order);
+
+	if (sortCancelled(options))
+	{
+		removeFiles(deltaRuns);
+
+		return false;
+	}
+
+	SortOptions baseOptions = options;
+
+	baseOptions.maxFileInts = options.maxFileInts - options.maxFileInts / 2;
+
+	chooseMergeShape(baseOptions, 1);
+
+	std::ifstream baseFile(basePath, std::ios::in | std::ios::binary);
+
+	if (!baseFile.is_open())
+	{
+		std::cout << "Error opening input file " << basePath << "." << std::endl;
+		exit(0);
+	}
+
+	FileInteger base;
+
+	base.ptrFileReadFrom = &baseFile;
+
+	base.numLeftToRead = fileLen(baseFile) / sizeof(int);
+
+	base.buffer = new int[baseOptions.bufferInts];
+
+	base.bufferCapacity = baseOptions.bufferInts;
+
+	std::vector<FileInteger*> baseFiles;
+
+	if (base.numLeftToRead > 0)
+		baseFiles.push_back(&base);
+
+	bool baseLeft = !baseFiles.empty();
+
+	Prefetcher<Order>* prefetcher = new Prefetcher<Order>(baseFiles, baseOptions.prefetchBuffers, io, order);
+
+	MergeStream<Order>* delta = new MergeStream<Order>(deltaRuns, true, deltaOptions, io, order);
+
+	OutputWriter output(updatedPath, baseOptions.outputBuffers, baseOptions.bufferInts, io);
+
+	if (options.indexInterval > 0)
+		output.buildIndex(indexFilePath(updatedPath), options.indexInterval);
+
+	const int* values;
+
+	int count;
+
+	while ((count = delta->next(values)) > 0)
+	{
+		const int* deltaEnd = values + count;
+
+		while (values < deltaEnd)
+		{
+			// Write the delta ints that come before the next base int
+			const int* deltaStop = baseLeft ? std::lower_bound(values, deltaEnd, base.buffer[base.bufferPos], order) : deltaEnd;
+
+			output.write(values, (int)(deltaStop - values));
+
+			values = deltaStop;
+
+			if (values == deltaEnd)
+				break;
+
+			// Then copy the base ints that do not come after the next delta int
+			while (baseLeft)
+			{
+				const int* baseStart = base.buffer + base.bufferPos;
+
+				const int* baseEnd = base.buffer + base.bufferLen;
+
+				const int* baseStop = order(*values, baseEnd[-1]) ? std::upper_bound(baseStart, baseEnd, *values, order) : baseEnd;
+
+				output.write(baseStart, (int)(baseStop - baseStart));
+
+				base.bufferPos += (int)(baseStop - baseStart);
+
+				if (baseStop != baseEnd)
+					break;
+
+				baseLeft = !sortCancelled(options) && prefetcher->nextBlock(&base);
+			}
+		}
+	}
+
+	// The rest of the base comes after every delta int
+	while (baseLeft)
+	{
+		output.write(base.buffer + base.bufferPos, base.bufferLen - base.bufferPos);
+
+		baseLeft = !sortCancelled(options) && prefetcher->nextBlock(&base);
+	}
+
+	output.close();
+
+	delete delta;
+
+	delete prefetcher;
+
+	delete[] base.buffer;
+
+	baseFile.close();
+
+	// Once cancelled, the delta hands out no more ints and no more blocks of the base are taken
+	if (sortCancelled(options))
+	{
+		removeOutput(updatedPath, options);
+
+		return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sortIntoRuns
+//
+//        Purpose:  Sorts a file into temp files, and merges them until few enough remain to be merged at
+//                  one time, so that the final merge can be piped into another operator.
+//
+//      Parameter:  path is the path of the file to sort. The program exits if it cannot be opened.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory while the temp files
+//                  are created, the directory and prefix of the temp files, and whether the sort is stable.
+//                  It receives the fan-in and buffer sizes chosen for the merges.
+//
+//      Parameter:  maxMergeInts is the maximum number of integers allowed in memory by the merges,
+//                  including the final one. The program exits if it is not more than one.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//        Returns:  The paths of the remaining temp files, in the order of their ints in the file, or no
+//                  paths if the sort was cancelled, in which case its temp files have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+std::vector<std::string> sortIntoRuns(const std::string& path, SortOptions& options, int maxMergeInts, IoBackend& io, const Order& order)
+{
+	std::ifstream inFile(path, std::ios::in | std::ios::binary);
+
+	if (!inFile.is_open())
+	{
+		std::cout << "Error opening input file " << path << "." << std::endl;
+		exit(0);
+	}
+
+	if (maxMergeInts <= 1)
+	{
+		std::cout << "Must allow more than one int in memory simultaneously for each merge." << std::endl;
+		exit(0);
+	}
+
+	// The runs are not checked, since they are consumed by another operator
+	unsigned long long inputHash = 0;
+
+	int numberOfFiles = makeTempFiles(inFile, options, io, order, inputHash);
+
+	inFile.close();
+
+	if (sortCancelled(options))
+	{
+		removeTempFiles(options, 0, numberOfFiles);
+
+		return std::vector<std::string>();
+	}
+
+	options.maxFileInts = maxMergeInts;
+
+	chooseMergeShape(options, numberOfFiles);
+
+	OvcCounters ovcCounters;
+
+	ovcCounters.codeDecisions = 0;
+
+	ovcCounters.fullComparisons = 0;
+
+	return reduceTempFiles(numberOfFiles, options, io, order, ovcCounters);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  makeTempFiles
+//
+//        Purpose:  Where k is the maximum number of ints from a file allowed in memory simultaneously,
+//                  this function reads k ints from the unsorted file, sorts them, writes them out to a
+//                  new file, and repeats until all ints in the unsorted file have been read. If k is
+//                  large enough, the ints are instead split into three chunks of k / 3 ints, and the
+//                  reads and writes are made asynchronously, so that while one chunk is sorted, the next
+//                  is read and the previous one is written.
+//
+//      Parameter:  unsortedFile is an ifstream object that has already opened the file to sort.
+//
+//      Parameter:  options holds maxFileInts, the maximum number of integers from the file that are
+//                  allowed in memory simultaneously. It also holds the directory to write the temp
+//                  files to, whether the sort checks its output, the tracker that is told as each chunk
+//                  is sorted, and the token that cancels the sort, which is checked before each chunk.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//      Parameter:  inputHash has the multiset hash of the unsorted file added to it if the sort checks
+//                  its output. Each chunk is hashed while it is in memory, so this costs no extra read.
+//
+//        Returns:  The number of temp files created, which is fewer than needed if the sort was cancelled.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+int makeTempFiles(std::ifstream& unsortedFile, const SortOptions& options, IoBackend& io, const Order& order, unsigned long long& inputHash)
+{
+	// Splitting the ints in memory into chunks is only worth it if the chunks are large enough that
+	// overlapping their I/O makes up for the extra temp files
+	const int NUM_CHUNKS = 3;
+
+	const int MIN_CHUNK_INTS = 65536;
+
+	int numChunks = (options.maxFileInts >= NUM_CHUNKS * MIN_CHUNK_INTS) ? NUM_CHUNKS : 1;
+
+	int chunkInts = options.maxFileInts / numChunks;
+
+	// The file may hold more ints than an int can count, but not more temp files than the merges can
+	// number, since each merge pass numbers its files after the files of the pass before it
+	long long amountLeftToRead = fileLen(unsortedFile) / sizeof(int);
+
+	long long numFilesNeeded = (amountLeftToRead + chunkInts - 1) / chunkInts;
+
+	if (numFilesNeeded > INT_MAX / 2)
+	{
+		std::cout << "The file would need " << numFilesNeeded << " temp files. Allow more ints in memory simultaneously." << std::endl;
+		exit(0);
+	}
+
+	int numberOfFiles = (int)numFilesNeeded;
+
+	SortChunk* chunks = new SortChunk[numChunks];
+
+	for (int i = 0; i < numChunks; i++)
+		chunks[i].values = new int[chunkInts];
+
+	// Chunk i % numChunks holds the ints of temp file i. Reads are started one chunk ahead of the
+	// chunk being sorted, or two if there are three chunks, so the third chunk can be written meanwhile.
+	int numReadsStarted = 0;
+
+	int numReadsAhead = (numChunks > 1) ? numChunks - 1 : 1;
+
+	for (int i = 0; i < numReadsAhead; i++)
+		startChunkRead(unsortedFile, chunks[numReadsStarted % numChunks], chunkInts, amountLeftToRead, numReadsStarted, io);
+
+	if (options.progress)
+		options.progress->beginPass("runs");
+
+	for (int fileNumber = 0; fileNumber < numberOfFiles; fileNumber++)
+	{
+		// A cancelled sort stops before its next chunk, and only the temp files written so far remain
+		if (sortCancelled(options))
+		{
+			numberOfFiles = fileNumber;
+
+			break;
+		}
+
+		SortChunk& chunk = chunks[fileNumber % numChunks];
+
+		// Read the chunk's ints, sort them, and write them to a new temp file
+		io.await(chunk.request);
+
+		if (options.selfCheck)
+			inputHash += hashInts(chunk.values, chunk.count);
+
+		sortRun(chunk.values, chunk.count, options.stable, order, std::integral_constant<bool, HasNormalizedKey<Order>::value>());
+
+		io.writeFile(chunk.request, tempFilePath(options, fileNumber), chunk.values, sizeof(int) * chunk.count);
+
+		if (options.progress)
+			options.progress->advance(sizeof(int) * chunk.count);
+
+		startChunkRead(unsortedFile, chunks[numReadsStarted % numChunks], chunkInts, amountLeftToRead, numReadsStarted, io);
+	}
+
+	for (int i = 0; i < numChunks; i++)
+	{
+		io.await(chunks[i].request);
+
+		delete[] chunks[i].values;
+	}
+
+	delete[] chunks;
+
+	return numberOfFiles;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sortRun
+//
+//        Purpose:  Sorts the ints of a chunk with a radix sort over their normalized keys. This version
+//                  is chosen when the order gives ints normalized keys.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  stable is true if ints that compare equal must keep their order.
+//
+//      Parameter:  The order to sort the ints in is only used for its type, since its keys are static.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void sortRun(int* values, int count, bool stable, const Order&, std::true_type)
+{
+	radixSort<Order>(values, count, stable);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sortRun
+//
+//        Purpose:  Sorts the ints of a chunk by comparing them. This version is chosen when the order
+//                  only compares ints.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  stable is true if ints that compare equal must keep their order.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void sortRun(int* values, int count, bool stable, const Order& order, std::false_type)
+{
+	if (stable)
+		std::stable_sort(values, values + count, order);
+	else
+		std::sort(values, values + count, order);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeTempFiles
+//
+//        Purpose:  Continuously merges all temp files created until only one large sorted file remains.
+//                  The last merge is written straight to the sorted file.
+//
+//      Parameter:  totalNumberOfFiles is the number of files that need to be merged.
+//
+//      Parameter:  options holds the fan-in, which is the maximum number of files that are merged at
+//                  one time, and the number of ints buffered from each file being merged. Their product
+//                  is at most the maximum number of integers allowed in memory simultaneously. It also
+//                  holds the directory that the temp files are in, and whether the merges use
+//                  offset-value coding, in which case the number of matches it decided is printed. The
+//                  memory budget and merge shape are shrunk if the sort is asked to use less memory.
+//
+//      Parameter:  sortedPath will be the path/name of the file once it is sorted.
+//
+//      Parameter:  io is the backend that reads blocks of the files ahead of time and writes the output.
+//
+//      Parameter:  order is the order the temp files are sorted in.
+//
+//        Returns:  The multiset hash of the sorted file if the options ask for the output to be checked,
+//                  or 0 otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+unsigned long long mergeTempFiles(int totalNumberOfFiles, SortOptions& options, std::string& sortedPath, IoBackend& io, const Order& order)
+{
+	// The number of merge matches decided by offset-value codes and by comparing full keys
+	OvcCounters ovcCounters;
+
+	ovcCounters.codeDecisions = 0;
+
+	ovcCounters.fullComparisons = 0;
+
+	std::vector<std::string> finalRuns = reduceTempFiles(totalNumberOfFiles, options, io, order, ovcCounters);
+
+	unsigned long long outputHash = 0;
+
+	// The sort may be cancelled after the last merge that reduced the files, so the runs that remain
+	// are removed here
+	if (sortCancelled(options))
+	{
+		removeFiles(finalRuns);
+
+		return outputHash;
+	}
+
+	// A single file is already the sorted file, so it is only renamed, unless it needs to be read to
+	// build the index or to be checked
+	if (finalRuns.size() == 1 && options.indexInterval == 0 && !options.selfCheck)
+	{
+		// A failed move leaves the file already at the sorted path as it was, so only the run is removed,
+		// rather than cancelling the sort, which would remove that file too
+		if (!moveFile(finalRuns[0], sortedPath))
+		{
+			removeFiles(finalRuns);
+
+			std::cout << "Error moving temp file " << finalRuns[0] << " to " << sortedPath << "." << std::endl;
+			exit(1);
+		}
+	}
+	else
+	{
+		if (options.progress)
+			options.progress->beginPass("merge");
+
+		outputHash = mergeRuns(finalRuns, true, sortedPath, options, io, order, ovcCounters, std::integral_constant<bool, HasNormalizedKey<Order>::value>());
+	}
+
+	reportOvcCounters(options, ovcCounters);
+
+	return outputHash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  reduceTempFiles
+//
+//        Purpose:  Merges groups of temp files into new temp files until few enough remain to be merged
+//                  at one time. The remaining files can then be merged into the sorted file, or piped
+//                  into another operator with a MergeStream.
+//
+//      Parameter:  totalNumberOfFiles is the number of temp files created from the unsorted file.
+//
+//      Parameter:  options holds the fan-in, the buffer sizes, the directory that the temp files are in,
+//                  whether the sort is stable, and whether the merges use offset-value coding. The memory
+//                  budget and merge shape are shrunk before a merge if the sort has been asked to use
+//                  less memory since the last one, so the final merge has the shape they are left with.
+//
+//      Parameter:  io is the backend that reads and writes the files.
+//
+//      Parameter:  order is the order the temp files are sorted in.
+//
+//      Parameter:  ovcCounters has the number of matches decided by codes and by full keys added to it.
+//
+//        Returns:  The paths of the remaining temp files, in the order of their ints in the unsorted file,
+//                  or no paths if the sort was cancelled, in which case its temp files have been removed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+std::vector<std::string> reduceTempFiles(int totalNumberOfFiles, SortOptions& options, IoBackend& io, const Order& order, OvcCounters& ovcCounters)
+{
+	// The next file to open and merge
+	int currentFileNumToMerge = 0;
+
+	// The first file created by the current merge pass. In stable mode, files are only merged together
+	// with files of the same pass, so that every file holds ints that were next to each other in the
+	// unsorted file, and the files of a pass are numbered in the order of those ints.
+	int passEnd = totalNumberOfFiles;
+
+	while (true)
+	{
+		// A merge keeps its buffers until it ends, so memory pressure is relieved before the next one
+		adaptToMemoryPressure(options, totalNumberOfFiles - currentFileNumToMerge);
+
+		// The runs of a cancelled merge are removed with it, so only the files not merged yet remain.
+		// This is checked before the last group is handed back, since its runs would be left behind.
+		if (sortCancelled(options))
+		{
+			removeTempFiles(options, currentFileNumToMerge, totalNumberOfFiles);
+
+			return std::vector<std::string>();
+		}
+
+		if (totalNumberOfFiles - currentFileNumToMerge <= options.fanIn)
+			break;
+
+		// A pass starts with the first merge, and again once the files of the pass before it are used
+		// up. Outside of stable mode a merge can take files from both passes.
+		if (currentFileNumToMerge == 0 || currentFileNumToMerge >= passEnd)
+		{
+			if (currentFileNumToMerge > 0)
+				passEnd = totalNumberOfFiles;
+
+			if (options.progress)
+				options.progress->beginPass("merge");
+		}
+
+		int numFilesRemaining = (options.stable ? passEnd : totalNumberOfFiles) - currentFileNumToMerge;
+
+		// The number of files opened is equal to the fan-in unless that is greater than the number of
+		// files that remain to be merged.
+		int numFilesToOpen = (numFilesRemaining < options.fanIn) ? numFilesRemaining : options.fanIn;
+
+		// A file merged by itself is already sorted, so it is only renamed
+		if (numFilesToOpen == 1)
+		{
+			// A failed move cancels the sort, which removes the file with the others not merged yet
+			if (!moveFile(tempFilePath(options, currentFileNumToMerge), tempFilePath(options, totalNumberOfFiles)))
+			{
+				io.fail("Error moving temp file " + tempFilePath(options, currentFileNumToMerge) + ".");
+
+				continue;
+			}
+
+			currentFileNumToMerge++;
+
+			totalNumberOfFiles++;
+
+			continue;
+		}
+
+		std::vector<std::string> group;
+
+		for (int i = 0; i < numFilesToOpen; i++, currentFileNumToMerge++)
+			group.push_back(tempFilePath(options, currentFileNumToMerge));
+
+		// Temp files are not indexed or checked
+		SortOptions passOptions = options;
+
+		passOptions.indexInterval = 0;
+
+		passOptions.selfCheck = false;
+
+		mergeRuns(group, true, tempFilePath(options, totalNumberOfFiles), passOptions, io, order, ovcCounters, std::integral_constant<bool, HasNormalizedKey<Order>::value>());
+
+		totalNumberOfFiles++;
+	}
+
+	// The files left over from the previous pass hold the ints at the end of the unsorted file, after
+	// the ints in the files of the current pass
+	std::vector<std::string> remaining;
+
+	int firstInOrder = (options.stable && currentFileNumToMerge < passEnd) ? passEnd : currentFileNumToMerge;
+
+	for (int i = firstInOrder; i < totalNumberOfFiles; i++)
+		remaining.push_back(tempFilePath(options, i));
+
+	for (int i = currentFileNumToMerge; i < firstInOrder; i++)
+		remaining.push_back(tempFilePath(options, i));
+
+	return remaining;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeRuns
+//
+//        Purpose:  Merges a group of sorted runs into one file, with an offset-value coded tree if the
+//                  options ask for one, or with a plain loser tree otherwise. This version is chosen when
+//                  the order gives ints normalized keys, which offset-value coding needs.
+//
+//      Parameter:  runPaths holds the paths of the runs, in the order of their ints in the input.
+//
+//      Parameter:  removeRuns is true if the runs should be deleted once they are merged.
+//
+//      Parameter:  outPath is the path of the merged file.
+//
+//      Parameter:  options holds the buffer sizes and whether to use offset-value coding.
+//
+//      Parameter:  io is the backend that reads the runs ahead of time and writes the output.
+//
+//      Parameter:  order is the order the runs are sorted in.
+//
+//      Parameter:  ovcCounters has the number of matches decided by codes and by full keys added to it.
+//
+//        Returns:  The multiset hash of the merged file if the options ask for the output to be checked,
+//                  or 0 otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+unsigned long long mergeRuns(const std::vector<std::string>& runPaths, bool removeRuns, const std::string& outPath, const SortOptions& options, IoBackend& io, const Order& order, OvcCounters& ovcCounters, std::true_type)
+{
+	if (options.offsetValueCoding)
+	{
+		MergeStream<Order, OvcLoserTree<Order>> stream(runPaths, removeRuns, options, io, order);
+
+		unsigned long long hash = writeStream(stream, outPath, options, io);
+
+		ovcCounters.codeDecisions += stream.mergeTree().ovcCounters().codeDecisions;
+
+		ovcCounters.fullComparisons += stream.mergeTree().ovcCounters().fullComparisons;
+
+		return hash;
+	}
+
+	MergeStream<Order> stream(runPaths, removeRuns, options, io, order);
+
+	return writeStream(stream, outPath, options, io);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeRuns
+//
+//        Purpose:  Merges a group of sorted runs into one file with a plain loser tree. This version is
+//                  chosen when the order only compares ints, so offset-value coding is not available.
+//
+//      Parameter:  runPaths holds the paths of the runs, in the order of their ints in the input.
+//
+//      Parameter:  removeRuns is true if the runs should be deleted once they are merged.
+//
+//      Parameter:  outPath is the path of the merged file.
+//
+//      Parameter:  options holds the buffer sizes.
+//
+//      Parameter:  io is the backend that reads the runs ahead of time and writes the output.
+//
+//      Parameter:  order is the order the runs are sorted in.
+//
+//      Parameter:  The offset-value coding counters are not used.
+//
+//        Returns:  The multiset hash of the merged file if the options ask for the output to be checked,
+//                  or 0 otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+unsigned long long mergeRuns(const std::vector<std::string>& runPaths, bool removeRuns, const std::string& outPath, const SortOptions& options, IoBackend& io, const Order& order, OvcCounters&, std::false_type)
+{
+	MergeStream<Order> stream(runPaths, removeRuns, options, io, order);
+
+	return writeStream(stream, outPath, options, io);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  writeStream
+//
+//        Purpose:  Writes all of the ints of a merge stream to a file, and its index if the options ask
+//                  for one. If the output is to be checked, the ints are hashed as they are written.
+//
+//      Parameter:  stream is the merge stream.
+//
+//      Parameter:  outPath is the path of the file to write.
+//
+//      Parameter:  options holds the size and number of the output buffers, the interval of the index,
+//                  whether the output is checked, and the tracker that is told as ints are written and
+//                  the token that stops the stream, if any.
+//
+//      Parameter:  io is the backend that writes the file.
+//
+//        Returns:  The multiset hash of the file if the output is checked, or 0 otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream>
+unsigned long long writeStream(Stream& stream, const std::string& outPath, const SortOptions& options, IoBackend& io)
+{
+	OutputWriter output(outPath, options.outputBuffers, options.bufferInts, io);
+
+	if (options.indexInterval > 0)
+		output.buildIndex(indexFilePath(outPath), options.indexInterval);
+
+	const int* values;
+
+	int count;
+
+	unsigned long long hash = 0;
+
+	while ((count = stream.next(values)) > 0)
+	{
+		if (options.selfCheck)
+			hash += hashInts(values, count);
+
+		output.write(values, count);
+
+		if (options.progress)
+			options.progress->advance(sizeof(int) * count);
+	}
+
+	output.close();
+
+	// A cancelled stream ends early, leaving the file incomplete
+	if (sortCancelled(options))
+		removeOutput(outPath, options);
+
+	return hash;
+}
+
+#endif
\ No newline at end of file
@@ -9,6 +9,9 @@
 //    Description:  This file contains the FileInteger struct declaration, which represents an integer read
 //                  from a file. It contains a pointer to the ifstream object it was read from,	the number
 //                  of integers left to read from the file, and the value that this struct represents.
+//                  The integers that follow the value in the file are kept in a block buffer so that the
+//                  merge can read, compare, and write them a block at a time, and the block after that
+//                  may be read ahead of time into a second buffer.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -17,23 +20,45 @@
 
 #include <fstream>
 
+#include "AsyncIo.h"
+
 // Represents an integer read from a file
 struct FileInteger
 {
 	// Pointer to the ifstream object that this integer was read from
 	std::ifstream* ptrFileReadFrom;
 
-	// The number of ints left to read from the file
-	int numLeftToRead;
+	// The index of the file among the files being merged
+	int fileIndex;
+
+	// The number of ints left in the file that have not been read or requested yet, which may be more
+	// than an int can hold for a large file
+	long long numLeftToRead;
 
-	// The value that was read from the file
+	// The value that was read from the file. This is always equal to buffer[bufferPos].
 	int value;
 
-	// Operator () overload that compares two FileIntegers
-	bool operator()(const FileInteger* a, const FileInteger* b)
-	{
-		return a->value > b->value;
-	}
+	// Block of ints read from the file, starting at the value that this struct represents
+	int* buffer;
+
+	// The number of ints the buffer can hold
+	int bufferCapacity;
+
+	// The index of value in the buffer
+	int bufferPos;
+
+	// The number of ints currently stored in the buffer
+	int bufferLen;
+
+	// Block of ints that is being read or has been read from the file ahead of time, to be used once
+	// the buffer runs out, or a null pointer if no block has been requested
+	int* prefetchBuffer;
+
+	// The number of ints in the prefetched block
+	int prefetchLen;
+
+	// The read of the prefetched block
+	IoRequest prefetchRequest;
 };
 
 #endif
\ No newline at end of file
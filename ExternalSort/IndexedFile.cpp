@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    IndexedFile.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the functions that name, write, and read the entries of the
+//                    sidecar index of a sorted file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IndexedFile.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  indexFilePath
+//
+//        Purpose:  Gives the path of the index of a sorted file.
+//
+//      Parameter:  sortedPath is the path of the sorted file.
+//
+//        Returns:  The path of the index, which is the path of the sorted file with ".idx" added.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string indexFilePath(const std::string& sortedPath)
+{
+	return sortedPath + ".idx";
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  writeIndexEntry
+//
+//        Purpose:  Writes an entry to the end of an index.
+//
+//      Parameter:  indexFile is the index file, already open.
+//
+//      Parameter:  key is the int of the sorted file.
+//
+//      Parameter:  offset is the byte offset of the int in the sorted file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void writeIndexEntry(std::ofstream& indexFile, int key, long long offset)
+{
+	indexFile.write((const char*)&key, sizeof(int));
+
+	indexFile.write((const char*)&offset, sizeof(long long));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readIndexEntry
+//
+//        Purpose:  Reads the next entry of an index.
+//
+//      Parameter:  indexFile is the index file, already open.
+//
+//      Parameter:  entry receives the entry.
+//
+//        Returns:  True if an entry was read, or false if the end of the index was reached.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool readIndexEntry(std::ifstream& indexFile, IndexEntry& entry)
+{
+	indexFile.read((char*)&entry.key, sizeof(int));
+
+	indexFile.read((char*)&entry.offset, sizeof(long long));
+
+	return (bool)indexFile;
+}
@@ -0,0 +1,325 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  IndexedFile.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the sidecar index of a sorted file and the IndexedFile class
+//                  template, which looks up ints in a sorted file with it. The index is written next to
+//                  the sorted file by the final merge, and holds every Nth int of the file with its byte
+//                  offset, like the fence pointers of an SSTable. A lookup binary searches the index in
+//                  memory and then reads a single block of N ints from the file, so the sorted file can
+//                  be queried as soon as it is written without being read in full.
+//
+//                  The index file starts with N, followed by one entry per N ints of the sorted file. An
+//                  entry is the int followed by its byte offset in the sorted file as an 8-byte number.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INDEXEDFILE_H
+#define INDEXEDFILE_H
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// An int of a sorted file that is in its index
+struct IndexEntry
+{
+	int key;
+
+	// The byte offset of the int in the sorted file
+	long long offset;
+};
+
+std::string indexFilePath(const std::string&);
+void writeIndexEntry(std::ofstream&, int, long long);
+bool readIndexEntry(std::ifstream&, IndexEntry&);
+
+template <class Order>
+class IndexedFile
+{
+public:
+	IndexedFile(const std::string&, const Order& = Order());
+	~IndexedFile();
+
+	long long size() const;
+	long long lowerBound(int);
+	long long upperBound(int);
+	void read(long long, int, int*);
+	std::vector<int> range(int, int);
+
+private:
+	long long search(int, bool);
+	bool passes(int, int, bool) const;
+
+	// The sorted file
+	std::ifstream file;
+
+	// The number of ints in the sorted file
+	long long numInts;
+
+	// The number of ints between two entries of the index
+	int interval;
+
+	// The entries of the index, in the order of their ints in the sorted file
+	std::vector<IndexEntry> entries;
+
+	// Holds the block of the sorted file being searched
+	int* block;
+
+	// The order the file is sorted in
+	Order order;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  IndexedFile
+//
+//        Purpose:  Opens a sorted file and loads its index into memory. The program exits if either
+//                  cannot be opened.
+//
+//      Parameter:  path is the path of the sorted file. Its index must be next to it.
+//
+//      Parameter:  sortOrder is the order the file is sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+IndexedFile<Order>::IndexedFile(const std::string& path, const Order& sortOrder)
+	: file(path, std::ios::in | std::ios::binary), order(sortOrder)
+{
+	std::ifstream indexFile(indexFilePath(path), std::ios::in | std::ios::binary);
+
+	if (!file.is_open() || !indexFile.is_open())
+	{
+		std::cout << "Error opening " << path << " or its index. Sort it with --index to create one." << std::endl;
+		exit(0);
+	}
+
+	file.seekg(0, std::ios::end);
+
+	numInts = (long long)file.tellg() / sizeof(int);
+
+	indexFile.read((char*)&interval, sizeof(int));
+
+	if (!indexFile || interval <= 0)
+	{
+		std::cout << "The index of " << path << " is not valid." << std::endl;
+		exit(0);
+	}
+
+	IndexEntry entry;
+
+	while (readIndexEntry(indexFile, entry))
+		entries.push_back(entry);
+
+	indexFile.close();
+
+	block = new int[interval];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~IndexedFile
+//
+//        Purpose:  Closes the sorted file and frees the block.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+IndexedFile<Order>::~IndexedFile()
+{
+	file.close();
+
+	delete[] block;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  size
+//
+//        Purpose:  Gives the number of ints in the sorted file.
+//
+//        Returns:  The number of ints.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+long long IndexedFile<Order>::size() const
+{
+	return numInts;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  lowerBound
+//
+//        Purpose:  Finds the first int of the file that does not come before a value.
+//
+//      Parameter:  value is the value to look up.
+//
+//        Returns:  The position of the int in the file, or the number of ints if every int comes before
+//                  the value.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+long long IndexedFile<Order>::lowerBound(int value)
+{
+	return search(value, false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  upperBound
+//
+//        Purpose:  Finds the first int of the file that the value comes before.
+//
+//      Parameter:  value is the value to look up.
+//
+//        Returns:  The position of the int in the file, or the number of ints if no int comes after the
+//                  value.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+long long IndexedFile<Order>::upperBound(int value)
+{
+	return search(value, true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  read
+//
+//        Purpose:  Reads consecutive ints of the file.
+//
+//      Parameter:  first is the position of the first int to read.
+//
+//      Parameter:  count is the number of ints to read. They must all be in the file.
+//
+//      Parameter:  values receives the ints.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void IndexedFile<Order>::read(long long first, int count, int* values)
+{
+	file.clear();
+
+	file.seekg(first * sizeof(int), std::ios::beg);
+
+	file.read((char*)values, count * sizeof(int));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  range
+//
+//        Purpose:  Finds every int of the file that is neither before the low value nor after the high
+//                  value. Looking up an int uses the same value for both.
+//
+//      Parameter:  low is the first value of the range in the order of the file.
+//
+//      Parameter:  high is the last value of the range in the order of the file.
+//
+//        Returns:  The ints in the range, in the order of the file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+std::vector<int> IndexedFile<Order>::range(int low, int high)
+{
+	long long first = lowerBound(low);
+
+	long long end = upperBound(high);
+
+	std::vector<int> values(end > first ? (size_t)(end - first) : 0);
+
+	if (!values.empty())
+		read(first, (int)values.size(), values.data());
+
+	return values;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  search
+//
+//        Purpose:  Finds the first int of the file that passes a test. The ints that pass come after all
+//                  the ints that do not, since the file is sorted. The last index entry that does not pass
+//                  is found by a binary search of the index, and the block of the file that starts there
+//                  is read and binary searched.
+//
+//      Parameter:  value is the value to look up.
+//
+//      Parameter:  pastEqual is true if ints equal to the value fail the test.
+//
+//        Returns:  The position of the int in the file, or the number of ints if none passes.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+long long IndexedFile<Order>::search(int value, bool pastEqual)
+{
+	// The first entry that passes
+	int low = 0;
+
+	int high = (int)entries.size();
+
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+
+		if (passes(entries[middle].key, value, pastEqual))
+			high = middle;
+		else
+			low = middle + 1;
+	}
+
+	// The entry before it is the first int of the block the answer is in, unless it is at the start of
+	// the next block
+	if (low == 0)
+		return 0;
+
+	long long blockStart = entries[low - 1].offset / sizeof(int);
+
+	int blockLen = (numInts - blockStart < interval) ? (int)(numInts - blockStart) : interval;
+
+	read(blockStart, blockLen, block);
+
+	int first = 1;
+
+	int last = blockLen;
+
+	while (first < last)
+	{
+		int middle = first + (last - first) / 2;
+
+		if (passes(block[middle], value, pastEqual))
+			last = middle;
+		else
+			first = middle + 1;
+	}
+
+	return blockStart + first;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  passes
+//
+//        Purpose:  Tests an int of the file while searching for a value.
+//
+//      Parameter:  key is the int of the file.
+//
+//      Parameter:  value is the value being searched for.
+//
+//      Parameter:  pastEqual is true if ints equal to the value fail the test.
+//
+//        Returns:  True if the value comes before the int, or is equal to it and pastEqual is not set.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool IndexedFile<Order>::passes(int key, int value, bool pastEqual) const
+{
+	return pastEqual ? order(value, key) : !order(key, value);
+}
+
+#endif
@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    KeyEncoding.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the functions that encode the columns of a
+//                    sort key into normalized byte strings, and that compare the encoded keys.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "KeyEncoding.h"
+
+static int encodeBits(unsigned int, bool, unsigned char*);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeInt
+//
+//        Purpose:  Encodes a signed int column of a key. The sign bit is flipped, so that negative ints
+//                  come before positive ones when the bytes are compared as unsigned.
+//
+//      Parameter:  value is the int to encode.
+//
+//      Parameter:  descending is true if larger ints should come first.
+//
+//      Parameter:  out is the buffer to write the 4 encoded bytes to.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int encodeInt(int value, bool descending, unsigned char* out)
+{
+	return encodeBits((unsigned int)value ^ 0x80000000u, descending, out);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeFloat
+//
+//        Purpose:  Encodes a float column of a key. The bits of negative floats are flipped, so that the
+//                  larger their magnitude the earlier they come, and positive floats have their sign bit
+//                  flipped, so that they come after all negative floats. Negative zero comes before
+//                  positive zero, and NaNs come after infinity if they are positive or before negative
+//                  infinity if they are negative.
+//
+//      Parameter:  value is the float to encode.
+//
+//      Parameter:  descending is true if larger floats should come first.
+//
+//      Parameter:  out is the buffer to write the 4 encoded bytes to.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int encodeFloat(float value, bool descending, unsigned char* out)
+{
+	unsigned int bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	bits = (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+
+	return encodeBits(bits, descending, out);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeString
+//
+//        Purpose:  Encodes a string column of a key. Each zero byte in the string is written as a zero
+//                  byte followed by 0xFF, and the string ends with two zero bytes. That way a string
+//                  comes before every longer string that starts with it, and no column after it can
+//                  change the order of two different strings.
+//
+//      Parameter:  chars holds the bytes of the string. It does not need to end with a null character.
+//
+//      Parameter:  length is the number of bytes in the string.
+//
+//      Parameter:  descending is true if strings should be in reverse order.
+//
+//      Parameter:  out is the buffer to write to. It must hold at least length * 2 + 2 bytes.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int encodeString(const char* chars, int length, bool descending, unsigned char* out)
+{
+	// Every byte is flipped for a descending column, which reverses the order of the encoded strings
+	unsigned char flip = descending ? 0xFF : 0x00;
+
+	int numBytes = 0;
+
+	for (int i = 0; i < length; i++)
+	{
+		unsigned char c = (unsigned char)chars[i];
+
+		out[numBytes++] = c ^ flip;
+
+		if (c == 0)
+			out[numBytes++] = 0xFF ^ flip;
+	}
+
+	out[numBytes++] = flip;
+
+	out[numBytes++] = flip;
+
+	return numBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  compareKeys
+//
+//        Purpose:  Compares two normalized keys byte by byte.
+//
+//      Parameter:  a is the first key.
+//
+//      Parameter:  aLength is the number of bytes in the first key.
+//
+//      Parameter:  b is the second key.
+//
+//      Parameter:  bLength is the number of bytes in the second key.
+//
+//        Returns:  A negative number if a comes first, a positive number if b comes first, or 0 if the
+//                  keys are equal. If one key starts with the other, the shorter one comes first.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int compareKeys(const unsigned char* a, int aLength, const unsigned char* b, int bLength)
+{
+	int result = memcmp(a, b, (aLength < bLength) ? aLength : bLength);
+
+	if (result != 0)
+		return result;
+
+	return aLength - bLength;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeBits
+//
+//        Purpose:  Writes 32 bits that already order correctly as an unsigned number, highest byte first.
+//
+//      Parameter:  bits is the number to write.
+//
+//      Parameter:  descending is true if the bits should be flipped to reverse their order.
+//
+//      Parameter:  out is the buffer to write the 4 bytes to.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int encodeBits(unsigned int bits, bool descending, unsigned char* out)
+{
+	if (descending)
+		bits = ~bits;
+
+	out[0] = (unsigned char)(bits >> 24);
+
+	out[1] = (unsigned char)(bits >> 16);
+
+	out[2] = (unsigned char)(bits >> 8);
+
+	out[3] = (unsigned char)bits;
+
+	return 4;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  KeyEncoding.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the functions that encode sort keys into normalized byte strings.
+//                  A normalized key orders the same way byte by byte with memcmp as the values it was
+//                  encoded from, so a composite key made of several columns of different types, each
+//                  ascending or descending, is compared with a single memcmp, and can be radix sorted
+//                  one byte at a time. The columns of a composite key are encoded one after another
+//                  into the same buffer.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef KEYENCODING_H
+#define KEYENCODING_H
+
+int encodeInt(int, bool, unsigned char*);
+int encodeFloat(float, bool, unsigned char*);
+int encodeString(const char*, int, bool, unsigned char*);
+int compareKeys(const unsigned char*, int, const unsigned char*, int);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeKey
+//
+//        Purpose:  Writes the normalized key that an order policy from SortOrder.h gives an int as a byte
+//                  string. The key is written from its highest byte to its lowest, and if its number of
+//                  bits is not a multiple of 8, the unused bits at the end of the last byte are zero.
+//
+//      Parameter:  value is the int to encode.
+//
+//      Parameter:  out is the buffer to write to. It must hold at least (Order::KEY_BITS + 7) / 8 bytes.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+int encodeKey(int value, unsigned char* out)
+{
+	const int numBytes = (Order::KEY_BITS + 7) / 8;
+
+	unsigned long long key = Order::key(value) << (numBytes * 8 - Order::KEY_BITS);
+
+	for (int i = numBytes - 1; i >= 0; i--, key >>= 8)
+		out[i] = (unsigned char)key;
+
+	return numBytes;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  LoserTree.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the LoserTree class template, a tournament tree used to repeatedly
+//                  find the first of the current ints of the files being merged in the order given by
+//                  an order policy. Each internal node holds the key and file index of the loser of the
+//                  match played there, and node 0 holds the overall winner. The keys and file indexes
+//                  are kept in two separate contiguous arrays, so a replay from a leaf to the root reads
+//                  one key and one index per level, and the upper levels of the tree share the same few
+//                  cache lines. Matches are decided with compare-and-select instead of branches.
+//
+//                  If the order gives ints normalized keys, each node caches the normalized key of its
+//                  int, so every match is a single unsigned comparison however many columns the order
+//                  has. Otherwise the node keeps the int itself and matches call the order.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOSERTREE_H
+#define LOSERTREE_H
+
+#include "SortOrder.h"
+
+// The key a loser tree node keeps for an int, and how two keys are compared. This version is used for
+// orders without normalized keys, and keeps the int itself.
+template <class Order, bool NORMALIZED = HasNormalizedKey<Order>::value>
+struct TreeKey
+{
+	typedef int Type;
+
+	static Type of(int value)
+	{
+		return value;
+	}
+
+	static bool less(Type a, Type b, const Order& order)
+	{
+		return order(a, b);
+	}
+};
+
+// The key a loser tree node keeps for an int under an order with normalized keys
+template <class Order>
+struct TreeKey<Order, true>
+{
+	typedef unsigned long long Type;
+
+	static Type of(int value)
+	{
+		return Order::key(value);
+	}
+
+	static bool less(Type a, Type b, const Order&)
+	{
+		return a < b;
+	}
+};
+
+template <class Order>
+class LoserTree
+{
+public:
+	// Plays the initial tournament between the first int of each of numFiles files. Every file must
+	// have at least one int.
+	LoserTree(const int* firstValues, int numFiles, const Order& sortOrder = Order())
+		: order(sortOrder)
+	{
+		// Round the number of leaves up to a power of two, and at least two so the winner always has a
+		// match to replay. The extra leaves hold exhausted files.
+		numLeaves = 2;
+
+		while (numLeaves < numFiles)
+			numLeaves *= 2;
+
+		nodeKeys = new Key[numLeaves];
+
+		nodeFiles = new int[numLeaves];
+
+		// Play the tournament from the leaves up, remembering the winner of every subtree
+		Key* winnerKeys = new Key[numLeaves * 2];
+
+		int* winnerFiles = new int[numLeaves * 2];
+
+		for (int i = 0; i < numLeaves; i++)
+		{
+			winnerKeys[numLeaves + i] = TreeKey<Order>::of((i < numFiles) ? firstValues[i] : 0);
+
+			winnerFiles[numLeaves + i] = (i < numFiles) ? i : exhausted(i);
+		}
+
+		for (int node = numLeaves - 1; node > 0; node--)
+		{
+			int left = node * 2;
+
+			int right = left + 1;
+
+			int winner = beats(winnerKeys[right], winnerFiles[right], winnerKeys[left], winnerFiles[left]) ? right : left;
+
+			int loser = (winner == left) ? right : left;
+
+			nodeKeys[node] = winnerKeys[loser];
+
+			nodeFiles[node] = winnerFiles[loser];
+
+			winnerKeys[node] = winnerKeys[winner];
+
+			winnerFiles[node] = winnerFiles[winner];
+		}
+
+		nodeKeys[0] = winnerKeys[1];
+
+		nodeFiles[0] = winnerFiles[1];
+
+		delete[] winnerKeys;
+
+		delete[] winnerFiles;
+	}
+
+	~LoserTree()
+	{
+		delete[] nodeKeys;
+
+		delete[] nodeFiles;
+	}
+
+	// Whether every file has run out of ints
+	bool empty() const
+	{
+		return nodeFiles[0] >= numLeaves;
+	}
+
+	// The index of the file with the first current int
+	int winner() const
+	{
+		return nodeFiles[0];
+	}
+
+	// The node holding the first current int of all files other than the winner. The only ints that can
+	// be second are the ones that lost directly to the winner, which are on its path to the root.
+	int runnerUp() const
+	{
+		int runnerUpNode = (numLeaves + nodeFiles[0]) / 2;
+
+		for (int node = runnerUpNode / 2; node > 0; node /= 2)
+		{
+			if (beats(nodeKeys[node], nodeFiles[node], nodeKeys[runnerUpNode], nodeFiles[runnerUpNode]))
+				runnerUpNode = node;
+		}
+
+		return runnerUpNode;
+	}
+
+	// Whether value, as the winner's next int, would still win against the int held at node
+	bool winnerBeats(int value, int node) const
+	{
+		return beats(TreeKey<Order>::of(value), nodeFiles[0], nodeKeys[node], nodeFiles[node]);
+	}
+
+	// Replaces the winner's int with the next int from the same file, and replays its matches from its
+	// leaf to the root to find the new winner
+	void replaceWinner(int value)
+	{
+		replay(TreeKey<Order>::of(value), nodeFiles[0]);
+	}
+
+	// Marks the winner's file as having no ints left, and replays its matches to find the new winner
+	void exhaustWinner()
+	{
+		replay(Key(), exhausted(nodeFiles[0]));
+	}
+
+private:
+	// The key kept in each node
+	typedef typename TreeKey<Order>::Type Key;
+
+	// The file index stored for a file that has no ints left. It is larger than every file index, so
+	// it loses to every file that has ints left.
+	int exhausted(int file) const
+	{
+		return numLeaves + file;
+	}
+
+	// Whether key a from file aFile comes before key b from file bFile. Ints that are equal by the order
+	// are won by the file with the lower index, which keeps the merge stable as long as the files are
+	// numbered in the order of their ints in the unsorted file.
+	bool beats(Key a, int aFile, Key b, int bFile) const
+	{
+		if ((aFile | bFile) >= numLeaves)
+			return aFile < bFile;
+
+		return TreeKey<Order>::less(a, b, order) || (!TreeKey<Order>::less(b, a, order) && aFile < bFile);
+	}
+
+	// Replays the winner's matches from its leaf to the root with the given key and file index
+	void replay(Key key, int file)
+	{
+		for (int node = (numLeaves + (file & (numLeaves - 1))) / 2; node > 0; node /= 2)
+		{
+			Key loserKey = nodeKeys[node];
+
+			int loserFile = nodeFiles[node];
+
+			// If the loser stored at this node wins the rematch, the two trade places
+			bool swap = beats(loserKey, loserFile, key, file);
+
+			nodeKeys[node] = swap ? key : loserKey;
+
+			nodeFiles[node] = swap ? file : loserFile;
+
+			key = swap ? loserKey : key;
+
+			file = swap ? loserFile : file;
+		}
+
+		nodeKeys[0] = key;
+
+		nodeFiles[0] = file;
+	}
+
+	// The order the ints are merged in
+	Order order;
+
+	// The number of leaves in the tree, which is the number of files rounded up to a power of two
+	int numLeaves;
+
+	// The key of the loser of each node's match, with the winner's key at index 0
+	Key* nodeKeys;
+
+	// The index of the file that lost each node's match, with the winner's file index at index 0. Files
+	// with no ints left are stored as their index plus numLeaves.
+	int* nodeFiles;
+};
+
+#endif
\ No newline at end of file
@@ -6,260 +6,604 @@
 //
 //         Author:    Nicholas Yoder
 //
-//    Description:    This file contains the entry point of the program and
-//                    functions for performing external sort on a binary file.
+//    Description:    This file contains the entry point of the program, which performs an external sort
+//                    on a binary file.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <csignal>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
-#include <queue>
 #include <fstream>
+#include <sstream>
 #include <string>
-
-#include "FileInteger.h"
-
-int makeTempFiles(std::ifstream&, int);
-void mergeTempFiles(int, int, std::string&);
-int fileLen(std::ifstream&);
+#include <vector>
+
+#include "AsyncIo.h"
+#include "Cancellation.h"
+#include "ExternalSort.h"
+#include "IndexedFile.h"
+#include "MemoryPressure.h"
+#include "MergeJoin.h"
+#include "Progress.h"
+#include "Quantiles.h"
+#include "ResourceLimits.h"
+#include "SetOperations.h"
+#include "SortOptions.h"
+#include "SortOrder.h"
+#include "Verify.h"
+
+template <class Order> bool runCommand(const std::vector<std::string>&, const std::string&, bool, SortOptions&, IoBackend&, const Order&);
+template <class Order> int parseValue(const std::string&, const Order&);
+template <class Direction> int parseValue(const std::string&, const AsFloat<Direction>&);
+template <class Order> std::string formatValue(int, const Order&);
+template <class Direction> std::string formatValue(int, const AsFloat<Direction>&);
+void printUsage();
+void printProgressLine(const ProgressEvent&, void*);
+void printProgressJson(const ProgressEvent&, void*);
+void onInterrupt(int);
+
+// The token that stops the command when it is interrupted or its deadline passes
+static CancelToken cancelToken;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Function Name:  main
 //
-//        Purpose:  Receives user input for the unsorted file name, the file to output the sorted
-//                  values to, and the maximum number of integers from a file that should be allowed
-//                  in memory simultaneously. Then, calls functions to perform the sort.
+//        Purpose:  Reads the command line and runs the command it gives. With no command, receives user
+//                  input for the unsorted file name, the file to output the sorted values to, and the
+//                  maximum number of integers from a file that should be allowed in memory
+//                  simultaneously, then sorts the file.
+//
+//      Parameter:  argc is the number of command line arguments.
+//
+//      Parameter:  argv holds the command line arguments. "sort <unsorted> <sorted>" sorts a file, and
+//                  "join <inner|left|anti> <left> <right> <joined>" sorts two files and joins them.
+//                  "union|intersect|difference <result> <input>..." sorts files and combines them as
+//                  sets, and with "--sorted" reads files that are already sorted without sorting them.
+//                  "merge <merged> <input>..." merges files that are each already sorted, and
+//                  "update <base> <delta> <updated>" merges an unsorted delta into a sorted base file.
+//                  "lookup <sorted> <low> [<high>]" finds the ints of an indexed sorted file that are
+//                  equal to a value or in a range. "quantile <input> <fraction>..." finds quantiles of a
+//                  file, such as 0.5 and 0.99, without sorting it. "verify <sorted> [<unsorted>]" checks
+//                  that a file is sorted, and that it holds the same ints as the unsorted file.
+//                  "--max-ints <count>" sets the maximum number of ints kept in memory, and is required
+//                  with a command. "--temp-dir <directory>" writes the temp files to the given directory
+//                  instead of the current directory. "--stable" keeps ints that compare equal in the
+//                  order they had in the unsorted file. "--descending" sorts the ints from largest to
+//                  smallest. "--float" treats the files as 32-bit floats instead of ints, sorts them by
+//                  their value with NaNs at the ends, and reads and prints values as floats. "--ovc"
+//                  merges with offset-value coding and prints how many key comparisons it saved.
+//                  "--null <int>" sets the int written for the missing right int of an unmatched left
+//                  int in a left join, which is 0 by default. "--index <interval>" writes an index next
+//                  to the output with every interval-th int of it. "--check" makes a sort or merge hash
+//                  its input and output as it goes, and report whether they match.
+//                  "--progress <text|json>" makes a sort or merge print its pass, how much of the pass
+//                  it has done, and how long it expects to take, once a second, as text or JSON lines.
+//                  "--deadline <seconds>" stops a command that sorts or merges if it has not finished in
+//                  time, as does Ctrl+C, and removes its temp files and output. A file that cannot be
+//                  opened, read, or written stops the command the same way. A cancelled or stopped
+//                  command exits with a status of 1.
+//                  The maximum number of ints is lowered if it would not fit under the memory limit of
+//                  the process's cgroup, and is halved for the merges that follow each SIGUSR1 or
+//                  memory pressure notification.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
-int main()
+int main(int argc, char* argv[])
 {
-	std::string unsortedPath, sortedPath;
-	int maxFileInts;
+	int maxFileInts = 0;
+
+	SortOptions options;
+
+	options.stable = false;
+
+	options.offsetValueCoding = false;
+
+	options.indexInterval = 0;
+
+	options.selfCheck = false;
+
+	options.memoryReliefs = 0;
 
-	std::cout << "Enter the name/path of the file to sort: ";
+	options.progress = nullptr;
 
-	std::getline(std::cin, unsortedPath);
+	options.cancel = nullptr;
 
-	std::cout << "Enter the name of the sorted file to output: ";
+	bool descending = false;
 
-	std::getline(std::cin, sortedPath);
+	bool floats = false;
 
-	std::cout << "Enter the maximum number of ints from the\nfile to keep in memory simultaneously: ";
+	std::string nullText = "0";
 
-	std::cin >> maxFileInts;
+	bool presorted = false;
 
-	if (maxFileInts <= 1)
+	std::string progressFormat;
+
+	double deadlineSeconds = 0;
+
+	std::vector<std::string> command;
+
+	for (int i = 1; i < argc; i++)
 	{
-		"Must allow more than one int in memory simultaneously.";
-		exit(0);
+		std::string arg = argv[i];
+
+		if (arg == "--temp-dir" && i + 1 < argc)
+			options.tempDirectory = argv[++i];
+		else if (arg == "--max-ints" && i + 1 < argc)
+			maxFileInts = atoi(argv[++i]);
+		else if (arg == "--index" && i + 1 < argc)
+			options.indexInterval = atoi(argv[++i]);
+		else if (arg == "--null" && i + 1 < argc)
+			nullText = argv[++i];
+		else if (arg == "--progress" && i + 1 < argc && (std::string(argv[i + 1]) == "text" || std::string(argv[i + 1]) == "json"))
+			progressFormat = argv[++i];
+		else if (arg == "--deadline" && i + 1 < argc)
+			deadlineSeconds = atof(argv[++i]);
+		else if (arg == "--stable")
+			options.stable = true;
+		else if (arg == "--descending")
+			descending = true;
+		else if (arg == "--float")
+			floats = true;
+		else if (arg == "--ovc")
+			options.offsetValueCoding = true;
+		else if (arg == "--check")
+			options.selfCheck = true;
+		else if (arg == "--sorted")
+			presorted = true;
+		else if (arg.compare(0, 2, "--") != 0)
+			command.push_back(arg);
+		else
+		{
+			printUsage();
+			exit(0);
+		}
 	}
 
-	// Open the file, and exit if it could not be opened
-	std::ifstream inFile(unsortedPath, std::ios::in | std::ios::binary);
+	if (command.empty())
+	{
+		std::string unsortedPath, sortedPath;
+
+		std::cout << "Enter the name/path of the file to sort: ";
+
+		std::getline(std::cin, unsortedPath);
+
+		std::cout << "Enter the name of the sorted file to output: ";
 
-	if (!inFile.is_open())
+		std::getline(std::cin, sortedPath);
+
+		std::cout << "Enter the maximum number of ints from the\nfile to keep in memory simultaneously: ";
+
+		std::cin >> maxFileInts;
+
+		command.push_back("sort");
+
+		command.push_back(unsortedPath);
+
+		command.push_back(sortedPath);
+	}
+
+	// Looking up ints only reads one block of the file at a time, so it needs no memory limit
+	if (maxFileInts <= 1 && command[0] != "lookup")
 	{
-		std::cout << "Error opening input file." << std::endl;
+		std::cout << "Must allow more than one int in memory simultaneously." << std::endl;
 		exit(0);
 	}
 
-	// Sort the file
-	int numberOfFiles = makeTempFiles(inFile, maxFileInts);
+	options.maxFileInts = maxFileInts;
 
-	inFile.close();
+	// A memory budget larger than the memory the process's container allows would get it killed
+	applyResourceLimits(options);
 
-	mergeTempFiles(numberOfFiles, maxFileInts, sortedPath);
+	// Lets SIGUSR1 and memory pressure on the system shrink the merges while the command runs
+	MemoryPressureWatch pressureWatch;
 
-	return 0;
-}
+	const double PROGRESS_INTERVAL_SECONDS = 1;
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-//  Function Name:  makeTempFiles
-//
-//        Purpose:  Where k is the maximum number of ints from a file allowed in memory simultaneously,
-//                  this function reads k ints from the unsorted file, sorts them, writes them out to a
-//                  new file, and repeats until all ints in the unsorted file have been read.
-//
-//      Parameter:  unsortedFile is an ifstream object that has already opened the file to sort.
-//
-//      Parameter:  maxFileInts is the maximum number of integers from the file that are allowed in
-//                  memory simultaneously. As a result, it is also the number of integers written to
-//                  each temp file.
-//
-//        Returns:  The number of temp files created.
-//
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
-int makeTempFiles(std::ifstream& unsortedFile, int maxFileInts)
-{
-	int amountLeftToRead = fileLen(unsortedFile) / sizeof(int);
+	ProgressTracker progress((progressFormat == "json") ? printProgressJson : printProgressLine, nullptr, PROGRESS_INTERVAL_SECONDS);
+
+	// Only sorts and merges report their progress, since they make a single series of passes over
+	// their input
+	if (!progressFormat.empty() && (command[0] == "sort" || command[0] == "merge"))
+		options.progress = &progress;
+
+	// Every stage of the sort has at most one read or write in flight per buffer, so only a handful
+	// are ever in flight at once
+	const int MAX_IO_IN_FLIGHT = 16;
 
-	int fileNumber = 0;
+	IoBackend io(MAX_IO_IN_FLIGHT);
 
-	while (amountLeftToRead > 0)
+	// Lookups, quantiles, and verification write no files, so they are left to be stopped as usual
+	if (command[0] != "lookup" && command[0] != "quantile" && command[0] != "verify")
 	{
-		// If the number of integers left to read in the unsorted file is less than the maximum number
-		// of integers that can be kept in memory simultaneously, then read only that amount
-		int numToRead = (amountLeftToRead < maxFileInts) ? amountLeftToRead : maxFileInts;
+		options.cancel = &cancelToken;
 
-		amountLeftToRead -= numToRead;
+		if (deadlineSeconds > 0)
+			cancelToken.setDeadline(deadlineSeconds);
 
-		// Read the specified number of ints into an array, and then sort the array
-		int* sortedValues = new int[numToRead];
+		signal(SIGINT, onInterrupt);
 
-		unsortedFile.read((char*)sortedValues, numToRead * sizeof(int));
+		// A file that cannot be opened, read, or written stops the command the same way, so that it
+		// removes its files
+		io.cancelOnFailure(&cancelToken);
+	}
 
-		std::sort(sortedValues, sortedValues + numToRead);
+	bool finished;
 
-		// Write sorted data from the current iteration to a new temp file
-		std::ofstream outFile(std::to_string(fileNumber), std::ios::out | std::ios::binary);
+	if (floats && descending)
+		finished = runCommand(command, nullText, presorted, options, io, AsFloat<Descending>());
+	else if (floats)
+		finished = runCommand(command, nullText, presorted, options, io, AsFloat<Ascending>());
+	else if (descending)
+		finished = runCommand(command, nullText, presorted, options, io, Descending());
+	else
+		finished = runCommand(command, nullText, presorted, options, io, Ascending());
 
-		outFile.write((char*)sortedValues, sizeof(int) * numToRead);
+	// A command stopped by an I/O error has already printed it
+	if (!finished && io.hasFailed())
+	{
+		std::cout << "Stopped before finishing. The temp files and output were removed." << std::endl;
 
-		outFile.close();
+		return 1;
+	}
 
-		fileNumber++;
+	// A cancelled command exits with a failure, so that whatever ran it can tell
+	if (!finished)
+	{
+		std::cout << "Cancelled before finishing. The temp files and output were removed." << std::endl;
 
-		delete[] sortedValues;
+		return 1;
 	}
 
-	return fileNumber;
+	return 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//  Function Name:  mergeTempFiles
+//  Function Name:  runCommand
 //
-//        Purpose:  Continuously merges all temp files created until only one large sorted file remains.
+//        Purpose:  Runs a sort, a merge, an update, a lookup, a quantile search, a verification, a join,
+//                  or a set operation in the given order. Prints the usage and exits if the command
+//                  is not valid.
 //
-//      Parameter:  totalNumberOfFiles is the number of files that need to be merged.
+//      Parameter:  command holds the name of the command followed by its arguments.
 //
-//      Parameter:  maxFileInts is the maximum number of integers from a file that are allowed in memory
-//                  simultaneously. As a result, it is also the maximum number of files that are merged
-//                  at one time.
+//      Parameter:  nullText is the value written for the missing right int of an unmatched left int in a
+//                  left join, as it was typed.
 //
-//      Parameter:  sortedPath will be the path/name of the file once it is sorted.
+//      Parameter:  presorted is true if the input files of a set operation are already sorted.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously, the
+//                  directory to write the temp files to, and whether the sort is stable.
+//
+//      Parameter:  io is the backend that carries out the reads and writes.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//        Returns:  True if the command finished, or false if it was cancelled.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
-void mergeTempFiles(int totalNumberOfFiles, int maxFileInts, std::string& sortedPath)
+template <class Order>
+bool runCommand(const std::vector<std::string>& command, const std::string& nullText, bool presorted, SortOptions& options, IoBackend& io, const Order& order)
 {
-	// The next file to open and merge
-	int currentFileNumToMerge = 0;
+	// Lookups, quantile searches, and verifications cannot be cancelled, so they always finish
+	bool finished = true;
+
+	if (command[0] == "sort" && command.size() == 3)
+	{
+		// Open the file, and exit if it could not be opened
+		std::ifstream inFile(command[1], std::ios::in | std::ios::binary);
+
+		if (!inFile.is_open())
+		{
+			std::cout << "Error opening input file." << std::endl;
+			exit(0);
+		}
+
+		std::string sortedPath = command[2];
 
-	while (currentFileNumToMerge < totalNumberOfFiles)
+		finished = sortFile(inFile, sortedPath, options, io, order);
+
+		inFile.close();
+	}
+	else if (command[0] == "merge" && command.size() >= 3)
 	{
-		int numFilesRemaining = totalNumberOfFiles - currentFileNumToMerge;
+		std::vector<std::string> inputPaths(command.begin() + 2, command.end());
 
-		// The number of files opened is equal to the maximum number of integers allowed in memory
-		// simultaneously unless that is greater than the number of files that remain to be merged.
-		int numFilesToOpen = (numFilesRemaining < maxFileInts) ? numFilesRemaining : maxFileInts;
+		finished = mergeFiles(inputPaths, command[1], options, io, order);
+	}
+	else if (command[0] == "update" && command.size() == 4)
+		finished = updateSortedFile(command[1], command[2], command[3], options, io, order);
+	else if (command[0] == "lookup" && (command.size() == 3 || command.size() == 4))
+	{
+		IndexedFile<Order> sorted(command[1], order);
 
-		// Open all files to merge data from and create a min heap of one integer from each file
-		std::ifstream* filesToMerge = new std::ifstream[numFilesToOpen];
+		int low = parseValue(command[2], order);
 
-		std::vector<FileInteger*> fileData(numFilesToOpen);
+		int high = (command.size() == 4) ? parseValue(command[3], order) : low;
 
-		for (int i = 0; i < numFilesToOpen; i++, currentFileNumToMerge++)
-		{
-			FileInteger* fi = new FileInteger;
+		long long first = sorted.lowerBound(low);
 
-			filesToMerge[i].open(std::to_string(currentFileNumToMerge), std::ios::in | std::ios::binary);
+		long long end = sorted.upperBound(high);
 
-			filesToMerge[i].read((char*)&fi->value, sizeof(int));
+		long long numFound = (end > first) ? end - first : 0;
 
-			fi->ptrFileReadFrom = &filesToMerge[i];
+		std::cout << "Found " << numFound << " ints, starting at int " << first << " of " << sorted.size() << "." << std::endl;
+	}
+	else if (command[0] == "quantile" && command.size() >= 3)
+	{
+		std::vector<double> fractions;
 
-			fi->numLeftToRead = (fileLen(filesToMerge[i]) / sizeof(int)) - 1;
+		for (int i = 2; i < (int)command.size(); i++)
+		{
+			double fraction = atof(command[i].c_str());
+
+			if (fraction < 0 || fraction > 1)
+			{
+				std::cout << "Quantiles must be between 0 and 1." << std::endl;
+				exit(0);
+			}
 
-			fileData[i] = fi;
+			fractions.push_back(fraction);
 		}
 
-		std::make_heap(fileData.begin(), fileData.end(), FileInteger());
+		std::vector<int> quantiles = findQuantiles(command[1], fractions, options, order);
+
+		for (int i = 0; i < (int)quantiles.size(); i++)
+			std::cout << "Quantile " << command[i + 2] << ": " << formatValue(quantiles[i], order) << std::endl;
+	}
+	else if (command[0] == "verify" && (command.size() == 2 || command.size() == 3))
+	{
+		VerifyResult sorted = verifyFile(command[1], options.maxFileInts, true, order);
+
+		if (sorted.firstUnsorted < 0)
+			std::cout << command[1] << " is sorted";
+		else
+			std::cout << command[1] << " is not sorted: int " << sorted.firstUnsorted << " comes before the int preceding it";
 
+		std::cout << ", and has " << sorted.numInts << " ints with multiset hash " << std::hex << sorted.hash << std::dec << "." << std::endl;
 
-		// While there are still integers left in the heap, remove the smallest integer and write it
-		// to the output file. Then, read a new integer from the file it belonged to as long as there
-		// is still data left to read from that file.
-		std::ofstream outFile(std::to_string(totalNumberOfFiles), std::ios::out | std::ios::binary);
+		if (command.size() == 3)
+		{
+			VerifyResult unsorted = verifyFile(command[2], options.maxFileInts, false, order);
 
-		while (fileData.size() > 0)
+			if (unsorted.numInts == sorted.numInts && unsorted.hash == sorted.hash)
+				std::cout << "It holds the same ints as " << command[2] << "." << std::endl;
+			else
+				std::cout << "It does not hold the same ints as " << command[2] << ", which has " << unsorted.numInts
+					<< " ints with multiset hash " << std::hex << unsorted.hash << std::dec << "." << std::endl;
+		}
+	}
+	else if (command[0] == "join" && command.size() == 5)
+	{
+		JoinType type;
+
+		if (command[1] == "inner")
+			type = INNER_JOIN;
+		else if (command[1] == "left")
+			type = LEFT_JOIN;
+		else if (command[1] == "anti")
+			type = ANTI_JOIN;
+		else
 		{
-			// Remove the smallest FileInteger from the heap
-			FileInteger* smallest = fileData.front();
+			printUsage();
+			exit(0);
+		}
 
-			std::pop_heap(fileData.begin(), fileData.end(), FileInteger());
+		finished = joinFiles(command[2], command[3], command[4], type, parseValue(nullText, order), options, io, order);
+	}
+	else if ((command[0] == "union" || command[0] == "intersect" || command[0] == "difference") && command.size() >= 3)
+	{
+		SetOperation operation = SET_UNION;
 
-			fileData.pop_back();
+		if (command[0] == "intersect")
+			operation = SET_INTERSECTION;
+		else if (command[0] == "difference")
+			operation = SET_DIFFERENCE;
 
-			// Write it to the output file
-			outFile.write((char*)&smallest->value, sizeof(int));
+		std::vector<std::string> inputPaths(command.begin() + 2, command.end());
 
-			// If there are still ints left to read from the file it belongs to, insert the next into the heap
-			if (smallest->numLeftToRead > 0)
-			{
-				// Create the next FileInteger
-				FileInteger* nextInteger = new FileInteger;
+		finished = combineFiles(inputPaths, command[1], operation, presorted, options, io, order);
+	}
+	else
+	{
+		printUsage();
+		exit(0);
+	}
 
-				smallest->ptrFileReadFrom->read((char*)&nextInteger->value, sizeof(int));
+	return finished;
+}
 
-				nextInteger->numLeftToRead = smallest->numLeftToRead - 1;
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  parseValue
+//
+//        Purpose:  Reads a value typed on the command line as an int.
+//
+//      Parameter:  text is the value as it was typed.
+//
+//      Parameter:  The order is only used to choose this version.
+//
+//        Returns:  The int.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+int parseValue(const std::string& text, const Order&)
+{
+	return atoi(text.c_str());
+}
 
-				nextInteger->ptrFileReadFrom = smallest->ptrFileReadFrom;
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  parseValue
+//
+//        Purpose:  Reads a value typed on the command line as a float, when the files hold floats.
+//
+//      Parameter:  text is the value as it was typed.
+//
+//      Parameter:  The order is only used to choose this version.
+//
+//        Returns:  The bits of the float, as they are stored in the files.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Direction>
+int parseValue(const std::string& text, const AsFloat<Direction>&)
+{
+	float value = (float)atof(text.c_str());
 
-				// Insert it into the heap
-				fileData.push_back(nextInteger);
+	int bits;
 
-				std::push_heap(fileData.begin(), fileData.end(), FileInteger());
-			}
+	memcpy(&bits, &value, sizeof(bits));
 
-			delete smallest;
-		}
+	return bits;
+}
 
-		// Close and delete all files that were merged, and delete the array of ifstream objects
-		int fileToDelete = currentFileNumToMerge - numFilesToOpen;
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  formatValue
+//
+//        Purpose:  Writes an int from a file as text.
+//
+//      Parameter:  value is the int.
+//
+//      Parameter:  The order is only used to choose this version.
+//
+//        Returns:  The text.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+std::string formatValue(int value, const Order&)
+{
+	return std::to_string(value);
+}
 
-		for (int i = 0; i < numFilesToOpen; i++, fileToDelete++)
-		{
-			filesToMerge[i].close();
-			remove(std::to_string(fileToDelete).c_str());
-		}
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  formatValue
+//
+//        Purpose:  Writes the bits of a float from a file as the float, when the files hold floats.
+//
+//      Parameter:  value is the bits of the float.
+//
+//      Parameter:  The order is only used to choose this version.
+//
+//        Returns:  The text, with enough digits to tell apart any two floats.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Direction>
+std::string formatValue(int value, const AsFloat<Direction>&)
+{
+	float floatValue;
 
-		delete[] filesToMerge;
+	memcpy(&floatValue, &value, sizeof(floatValue));
 
-		if (currentFileNumToMerge != totalNumberOfFiles)
-			totalNumberOfFiles++;
-	}
+	std::ostringstream text;
+
+	text << std::setprecision(9) << floatValue;
 
-	// Rename the sorted file as specified by sortedPath.
-	rename(std::to_string(currentFileNumToMerge).c_str(), sortedPath.c_str());
+	return text.str();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//  Function Name:  fileLen
+//  Function Name:  printUsage
 //
-//        Purpose:  Determines the length in bytes of an input file.
+//        Purpose:  Prints the command line options of the program.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void printUsage()
+{
+	std::cout << "Usage: ExternalSort [options]" << std::endl;
+	std::cout << "       ExternalSort [options] sort <unsorted> <sorted>" << std::endl;
+	std::cout << "       ExternalSort [options] merge <merged> <input>..." << std::endl;
+	std::cout << "       ExternalSort [options] update <base> <delta> <updated>" << std::endl;
+	std::cout << "       ExternalSort [options] lookup <sorted> <low> [<high>]" << std::endl;
+	std::cout << "       ExternalSort [options] quantile <input> <fraction>..." << std::endl;
+	std::cout << "       ExternalSort [options] verify <sorted> [<unsorted>]" << std::endl;
+	std::cout << "       ExternalSort [options] join <inner|left|anti> <left> <right> <joined>" << std::endl;
+	std::cout << "       ExternalSort [options] union|intersect|difference <result> <input>..." << std::endl;
+	std::cout << "Options: [--max-ints <count>] [--temp-dir <directory>] [--stable] [--descending] [--float] [--ovc] [--null <int>] [--sorted] [--index <interval>] [--check] [--progress <text|json>] [--deadline <seconds>]" << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//      Parameter:  file is an ifstream object with the file to determine the length of already open.
+//  Function Name:  onInterrupt
 //
-//        Returns:  The length of the file in bytes.
+//        Purpose:  Handles Ctrl+C by cancelling the command, so that it can remove its temp files. A
+//                  second Ctrl+C ends the program at once.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
-int fileLen(std::ifstream& file)
+void onInterrupt(int)
 {
-	int position = (int)file.tellg();
+	cancelToken.cancel();
+
+	signal(SIGINT, SIG_DFL);
+}
 
-	file.seekg(0, std::ios::beg);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  printProgressLine
+//
+//        Purpose:  Prints the progress of a sort as a line of text.
+//
+//      Parameter:  event is the progress of the sort.
+//
+//      Parameter:  The context is not used.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void printProgressLine(const ProgressEvent& event, void*)
+{
+	std::ostringstream line;
 
-	int start = (int)file.tellg();
+	line << std::fixed << std::setprecision(1);
 
-	file.seekg(0, std::ios::end);
+	if (strcmp(event.phase, "done") == 0)
+		line << "Done after " << event.numPasses << ((event.numPasses == 1) ? " pass" : " passes") << " in " << event.elapsedSeconds << " s.";
+	else
+	{
+		double percent = (event.passBytes > 0) ? 100.0 * event.passBytesDone / event.passBytes : 100;
 
-	int end = (int)file.tellg();
+		line << "Pass " << event.pass << " of " << event.numPasses << " (" << event.phase << "): " << percent
+			<< "% of " << event.passBytes << " bytes, " << event.elapsedSeconds << " s elapsed";
 
-	file.clear();
+		if (event.remainingSeconds >= 0)
+			line << ", about " << event.remainingSeconds << " s left";
 
-	file.seekg(position);
+		line << ".";
+	}
 
-	return end - start;
+	std::cout << line.str() << std::endl;
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  printProgressJson
+//
+//        Purpose:  Prints the progress of a sort as a line holding a JSON object, for other programs to
+//                  read. The time left is null until it can be estimated.
+//
+//      Parameter:  event is the progress of the sort.
+//
+//      Parameter:  The context is not used.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void printProgressJson(const ProgressEvent& event, void*)
+{
+	std::ostringstream line;
+
+	line << std::fixed << std::setprecision(3);
+
+	line << "{\"phase\":\"" << event.phase << "\",\"pass\":" << event.pass << ",\"passes\":" << event.numPasses
+		<< ",\"passBytesDone\":" << event.passBytesDone << ",\"passBytes\":" << event.passBytes
+		<< ",\"elapsedSeconds\":" << event.elapsedSeconds << ",\"remainingSeconds\":";
+
+	if (event.remainingSeconds >= 0)
+		line << event.remainingSeconds;
+	else
+		line << "null";
+
+	line << "}";
+
+	std::cout << line.str() << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    MemoryPressure.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the functions for asking the sorts to use less memory, shrinking
+//                    the merges when they are asked to, and watching for memory pressure.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "DeviceProfile.h"
+#include "MemoryPressure.h"
+#include "ResourceLimits.h"
+
+// The number of requests to use less memory made so far
+static std::atomic<int> numReliefRequests(0);
+
+// Requests stop halving the memory budget once it would fall below this many ints, since smaller
+// buffers make the merges slower without freeing much
+static const int MIN_RELIEVED_INTS = 65536;
+
+static void onReliefSignal(int);
+static long long readHighEvents(const std::string&);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  relieveMemoryPressure
+//
+//        Purpose:  Asks the sorts of the process to halve the memory their merges use, starting with the
+//                  next merge each of them starts. This only updates an atomic counter, so it can be
+//                  called from any thread or from a signal handler.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void relieveMemoryPressure()
+{
+	numReliefRequests++;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  adaptToMemoryPressure
+//
+//        Purpose:  Halves the memory budget of a sort's merges once for each request to use less memory
+//                  made since the last time it was called for the sort, and chooses a new merge shape
+//                  for the smaller budget. The fan-in is never raised, since a smaller budget never calls
+//                  for merging more files at once. Prints a note if the budget was halved.
+//
+//      Parameter:  options holds the memory budget and merge shape of the sort, and the number of
+//                  requests already acted on, which are all updated.
+//
+//      Parameter:  numFiles is the number of files that remain to be merged.
+//
+//        Returns:  True if the budget was halved.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool adaptToMemoryPressure(SortOptions& options, int numFiles)
+{
+	int numRequests = numReliefRequests;
+
+	int numNewRequests = numRequests - options.memoryReliefs;
+
+	options.memoryReliefs = numRequests;
+
+	int minInts = (options.maxFileInts < MIN_RELIEVED_INTS) ? options.maxFileInts : MIN_RELIEVED_INTS;
+
+	int maxFileInts = options.maxFileInts;
+
+	for (int i = 0; i < numNewRequests && maxFileInts / 2 >= minInts; i++)
+		maxFileInts /= 2;
+
+	if (maxFileInts == options.maxFileInts)
+		return false;
+
+	int fanIn = options.fanIn;
+
+	options.maxFileInts = maxFileInts;
+
+	chooseMergeShape(options, numFiles);
+
+	if (options.fanIn > fanIn)
+	{
+		options.fanIn = fanIn;
+
+		options.bufferInts = maxFileInts / (fanIn + options.prefetchBuffers + options.outputBuffers);
+	}
+
+	std::cout << "Memory is short: merging with at most " << maxFileInts << " ints in memory, " << options.fanIn
+		<< " files at a time." << std::endl;
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  MemoryPressureWatch
+//
+//        Purpose:  Makes SIGUSR1 ask the sorts to use less memory, and starts the watch thread on Linux.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+MemoryPressureWatch::MemoryPressureWatch()
+	: stopping(false)
+{
+#ifdef __linux__
+	signal(SIGUSR1, onReliefSignal);
+
+	cgroupDirectory = detectResourceLimits().cgroupDirectory;
+
+	watchThread = std::thread(&MemoryPressureWatch::run, this);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~MemoryPressureWatch
+//
+//        Purpose:  Stops the watch thread.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+MemoryPressureWatch::~MemoryPressureWatch()
+{
+	stopping = true;
+
+	if (watchThread.joinable())
+		watchThread.join();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  run
+//
+//        Purpose:  Waits for memory pressure until the watch is stopped. A pressure stall trigger is set
+//                  on the cgroup's memory.pressure file, or on the system's if the cgroup was not found,
+//                  so that the kernel wakes the thread when tasks spend 150ms of a 2s window waiting for
+//                  memory. Windows that are a multiple of 2s can be set without privileges. The thread
+//                  also wakes every WAIT_MILLISECONDS to check whether the cgroup has gone over
+//                  memory.high since it last looked, and to see whether it should stop. If the trigger
+//                  cannot be set, only memory.high is watched.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void MemoryPressureWatch::run()
+{
+#ifdef __linux__
+	const int WAIT_MILLISECONDS = 100;
+
+	const char* TRIGGER = "some 150000 2000000";
+
+	std::string pressurePath = cgroupDirectory.empty() ? "/proc/pressure/memory" : cgroupDirectory + "/memory.pressure";
+
+	int fd = open(pressurePath.c_str(), O_RDWR | O_NONBLOCK);
+
+	if (fd >= 0 && write(fd, TRIGGER, strlen(TRIGGER) + 1) < 0)
+	{
+		close(fd);
+
+		fd = -1;
+	}
+
+	long long highEvents = readHighEvents(cgroupDirectory);
+
+	while (!stopping)
+	{
+		// Polling a negative descriptor only waits out the timeout
+		pollfd trigger;
+
+		trigger.fd = fd;
+
+		trigger.events = POLLPRI;
+
+		trigger.revents = 0;
+
+		if (poll(&trigger, 1, WAIT_MILLISECONDS) > 0)
+		{
+			if (trigger.revents & POLLPRI)
+				relieveMemoryPressure();
+			else
+			{
+				close(fd);
+
+				fd = -1;
+			}
+		}
+
+		long long events = readHighEvents(cgroupDirectory);
+
+		if (events > highEvents)
+			relieveMemoryPressure();
+
+		highEvents = events;
+	}
+
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  onReliefSignal
+//
+//        Purpose:  Handles SIGUSR1 by asking the sorts to use less memory.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void onReliefSignal(int)
+{
+	relieveMemoryPressure();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readHighEvents
+//
+//        Purpose:  Reads how many times a cgroup has gone over memory.high, from its memory.events file.
+//
+//      Parameter:  cgroupDirectory is the directory of the cgroup, or an empty string.
+//
+//        Returns:  The number of times, or 0 if the cgroup has no memory.events file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static long long readHighEvents(const std::string& cgroupDirectory)
+{
+	if (cgroupDirectory.empty())
+		return 0;
+
+	std::ifstream eventsFile(cgroupDirectory + "/memory.events");
+
+	std::string name;
+
+	long long count;
+
+	while (eventsFile >> name >> count)
+	{
+		if (name == "high")
+			return count;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  MemoryPressure.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the functions that let a sort give memory back while it runs, and
+//                  the MemoryPressureWatch class, which asks it to when the system runs short. Anything
+//                  may ask the sorts of the process to use less memory by calling relieveMemoryPressure,
+//                  which is safe to call from any thread or from a signal handler. Each request halves
+//                  the memory budget of every merge that starts after it, which shrinks the prefetch and
+//                  output buffers along with the buffer of each file, and lowers the fan-in if the merges
+//                  are better off with fewer, larger buffers. A merge keeps its buffers until it ends,
+//                  so the sort is never aborted, and a request is acted on at the next merge.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEMORYPRESSURE_H
+#define MEMORYPRESSURE_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "SortOptions.h"
+
+void relieveMemoryPressure();
+bool adaptToMemoryPressure(SortOptions&, int);
+
+// Watches for memory pressure in the background and asks the sorts to use less memory when it finds
+// some. On Linux, SIGUSR1 makes a request, as do pressure stall notifications for the process's cgroup
+// and the cgroup going over memory.high. Elsewhere there is nothing to watch.
+class MemoryPressureWatch
+{
+public:
+	MemoryPressureWatch();
+	~MemoryPressureWatch();
+
+private:
+	void run();
+
+	// The directory of the process's cgroup, or an empty string if it was not found
+	std::string cgroupDirectory;
+
+	// Set once the watch thread should stop
+	std::atomic<bool> stopping;
+
+	// The thread that waits for notifications
+	std::thread watchThread;
+};
+
+#endif
\ No newline at end of file
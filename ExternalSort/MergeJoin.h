@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  MergeJoin.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the merge-join operator, which joins two streams of ints sorted in
+//                  the same order. Two ints match if neither comes before the other in the order, so an
+//                  order that compares one column of the ints joins on that column. Each side is read
+//                  once, in order, through a StreamCursor, so the sides can be the final merges of two
+//                  sorts that are piped straight into the join instead of being written out first.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MERGEJOIN_H
+#define MERGEJOIN_H
+
+#include <vector>
+
+#include "OutputWriter.h"
+#include "StreamCursor.h"
+
+// The kinds of join
+enum JoinType
+{
+	// Writes every pair of matching left and right ints
+	INNER_JOIN,
+
+	// Writes every pair of matching left and right ints, and every left int with no match paired with
+	// a null value
+	LEFT_JOIN,
+
+	// Writes every left int with no match
+	ANTI_JOIN
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeJoin
+//
+//        Purpose:  Joins two sorted streams of ints. For each group of equal left ints, the right ints
+//                  equal to them are gathered in memory, and every left int of the group is written with
+//                  each of them. Inner and left joins write each result as a pair of ints, the left int
+//                  followed by the right int. An anti join writes the left ints alone.
+//
+//      Parameter:  left is the left stream.
+//
+//      Parameter:  right is the right stream. A group of equal right ints must fit in memory.
+//
+//      Parameter:  type is the kind of join.
+//
+//      Parameter:  nullValue is the int that stands in for the missing right int of an unmatched left
+//                  int in a left join.
+//
+//      Parameter:  output is the writer of the joined file.
+//
+//      Parameter:  order is the order both streams are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class LeftStream, class RightStream>
+void mergeJoin(LeftStream& left, RightStream& right, JoinType type, int nullValue, OutputWriter& output, const Order& order)
+{
+	StreamCursor<LeftStream> leftCursor(left);
+
+	StreamCursor<RightStream> rightCursor(right);
+
+	// The right ints that match the current group of left ints
+	std::vector<int> rightGroup;
+
+	while (!leftCursor.atEnd())
+	{
+		int key = leftCursor.value();
+
+		// Skip the right ints that come before the group, since they match nothing
+		rightCursor.seek(key, false, order);
+
+		rightGroup.clear();
+
+		while (!rightCursor.atEnd() && !order(key, rightCursor.value()))
+		{
+			rightGroup.push_back(rightCursor.value());
+
+			rightCursor.advance();
+		}
+
+		// Write the results for every left int of the group
+		do
+		{
+			int row[2] = { leftCursor.value(), nullValue };
+
+			if (rightGroup.empty())
+			{
+				if (type == LEFT_JOIN)
+					output.write(row, 2);
+				else if (type == ANTI_JOIN)
+					output.write(row, 1);
+			}
+			else if (type != ANTI_JOIN)
+			{
+				for (int i = 0; i < (int)rightGroup.size(); i++)
+				{
+					row[1] = rightGroup[i];
+
+					output.write(row, 2);
+				}
+			}
+
+			leftCursor.advance();
+		} while (!leftCursor.atEnd() && !order(key, leftCursor.value()));
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,325 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  MergeStream.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the MergeStream class template, which merges a group of sorted run
+//                  files and hands out the merged ints in order, one stretch at a time, to whatever
+//                  consumes them. A merge pass writes the stretches to a file, and the last merge of a
+//                  sort can be piped straight into another operator, such as a join, without the sorted
+//                  file ever being written. The tree the runs are merged with is a template parameter, so
+//                  either a LoserTree or an OvcLoserTree can be used.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MERGESTREAM_H
+#define MERGESTREAM_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "AsyncIo.h"
+#include "FileInteger.h"
+#include "LoserTree.h"
+#include "Prefetcher.h"
+#include "SortOptions.h"
+
+long long fileLen(std::ifstream&);
+template <class Tree> int winningStretch(const Tree&, const int*, int);
+
+template <class Order, class Tree = LoserTree<Order>>
+class MergeStream
+{
+public:
+	MergeStream(const std::vector<std::string>&, bool, const SortOptions&, IoBackend&, const Order& = Order());
+	~MergeStream();
+
+	int next(const int*&);
+	const Tree& mergeTree() const;
+
+private:
+	void advance();
+
+	// The paths of the runs being merged
+	std::vector<std::string> runPaths;
+
+	// Whether the runs are deleted once they have been merged
+	bool removeRuns;
+
+	// The runs that have ints, opened for reading
+	std::ifstream* runFiles;
+
+	// The runs that have ints, in the order their ints appear in the input
+	std::vector<FileInteger*> fileData;
+
+	// Reads the blocks of the runs
+	Prefetcher<Order>* prefetcher;
+
+	// Finds the run with the first current int
+	Tree* tree;
+
+	// The run whose stretch was handed out by the last call to next, or -1 if there is none
+	int pendingRun;
+
+	// The number of ints in that stretch
+	int pendingCount;
+
+	// The number of times in a row the same run has won
+	int numWinsInARow;
+
+	// The token that stops the merge once it is cancelled, or a null pointer
+	CancelToken* cancel;
+
+	// Whether the merge was stopped because the token was cancelled
+	bool stopped;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  MergeStream
+//
+//        Purpose:  Opens the runs, reads the first block of each, and plays a tournament between their
+//                  first ints. Runs with no ints are skipped.
+//
+//      Parameter:  paths holds the paths of the sorted runs. Runs that compare equal are handed out in
+//                  the order the runs are listed, so for a stable merge, they must be listed in the order
+//                  of their ints in the input.
+//
+//      Parameter:  removeWhenDone is true if the runs should be deleted once the stream is destroyed.
+//
+//      Parameter:  options holds the number of ints buffered from each run, the number of spare
+//                  buffers to read ahead into, and the token that stops the merge, if any.
+//
+//      Parameter:  io is the backend that reads blocks of the runs ahead of time.
+//
+//      Parameter:  order is the order the runs are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class Tree>
+MergeStream<Order, Tree>::MergeStream(const std::vector<std::string>& paths, bool removeWhenDone, const SortOptions& options, IoBackend& io, const Order& order)
+	: runPaths(paths), removeRuns(removeWhenDone), pendingRun(-1), pendingCount(0), numWinsInARow(0),
+	cancel(options.cancel), stopped(false)
+{
+	runFiles = new std::ifstream[runPaths.size()];
+
+	for (int i = 0; i < (int)runPaths.size(); i++)
+	{
+		runFiles[i].open(runPaths[i], std::ios::in | std::ios::binary);
+
+		long long numInts = runFiles[i].is_open() ? fileLen(runFiles[i]) / sizeof(int) : 0;
+
+		if (numInts == 0)
+			continue;
+
+		FileInteger* fi = new FileInteger;
+
+		fi->ptrFileReadFrom = &runFiles[i];
+
+		fi->numLeftToRead = numInts;
+
+		fi->buffer = new int[options.bufferInts];
+
+		fi->bufferCapacity = options.bufferInts;
+
+		fileData.push_back(fi);
+	}
+
+	prefetcher = new Prefetcher<Order>(fileData, options.prefetchBuffers, io, order);
+
+	std::vector<int> firstValues(fileData.size());
+
+	for (int i = 0; i < (int)fileData.size(); i++)
+		firstValues[i] = fileData[i]->value;
+
+	tree = new Tree(firstValues.data(), (int)fileData.size(), order);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~MergeStream
+//
+//        Purpose:  Closes the runs, deleting them if asked to, and frees the buffers.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class Tree>
+MergeStream<Order, Tree>::~MergeStream()
+{
+	delete tree;
+
+	delete prefetcher;
+
+	for (int i = 0; i < (int)fileData.size(); i++)
+	{
+		delete[] fileData[i]->buffer;
+
+		delete fileData[i];
+	}
+
+	for (int i = 0; i < (int)runPaths.size(); i++)
+	{
+		runFiles[i].close();
+
+		if (removeRuns)
+			remove(runPaths[i].c_str());
+	}
+
+	delete[] runFiles;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  next
+//
+//        Purpose:  Hands out the next ints of the merge. The first int of the stretch is the winner of
+//                  the tree. Once the same run has won MIN_GALLOP times in a row, every int after the
+//                  winner in its buffer that still wins against the first int of the other runs is
+//                  handed out along with it.
+//
+//      Parameter:  values is set to point to the stretch of ints. They stay valid until next is called
+//                  again.
+//
+//        Returns:  The number of ints in the stretch, or 0 if every run has been merged or the merge
+//                  was cancelled.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class Tree>
+int MergeStream<Order, Tree>::next(const int*& values)
+{
+	const int MIN_GALLOP = 7;
+
+	// The ints handed out last time are only consumed now, since the next block of their run may be
+	// read into the buffer they are in
+	advance();
+
+	if (stopped || tree->empty())
+		return 0;
+
+	FileInteger* winner = fileData[tree->winner()];
+
+	numWinsInARow = (tree->winner() == pendingRun) ? numWinsInARow + 1 : 1;
+
+	pendingRun = tree->winner();
+
+	values = winner->buffer + winner->bufferPos;
+
+	pendingCount = 1;
+
+	if (numWinsInARow >= MIN_GALLOP)
+		pendingCount = winningStretch(*tree, values, winner->bufferLen - winner->bufferPos);
+
+	return pendingCount;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mergeTree
+//
+//        Purpose:  Gives access to the tree the runs are merged with, such as for its counters.
+//
+//        Returns:  The tree.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class Tree>
+const Tree& MergeStream<Order, Tree>::mergeTree() const
+{
+	return *tree;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  advance
+//
+//        Purpose:  Moves past the stretch handed out by the last call to next. If the stretch's run has
+//                  ints left, the next one replaces the stretch in the tree. Before a run's next block
+//                  is taken, the merge checks whether it has been cancelled, and stops if it has.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order, class Tree>
+void MergeStream<Order, Tree>::advance()
+{
+	if (pendingCount == 0)
+		return;
+
+	FileInteger* winner = fileData[pendingRun];
+
+	winner->bufferPos += pendingCount;
+
+	pendingCount = 0;
+
+	if (winner->bufferPos == winner->bufferLen && cancel != nullptr && cancel->isCancelled())
+	{
+		stopped = true;
+
+		return;
+	}
+
+	if (winner->bufferPos < winner->bufferLen || prefetcher->nextBlock(winner))
+	{
+		winner->value = winner->buffer[winner->bufferPos];
+
+		tree->replaceWinner(winner->value);
+	}
+	else
+		tree->exhaustWinner();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  winningStretch
+//
+//        Purpose:  Counts how many ints at the start of a sorted block win against the first int of
+//                  every other file being merged, so that they can all be written at once. The
+//                  block is galloped through by comparing the ints at exponentially growing distances
+//                  from the start, and the exact end of the stretch is then found with a binary search.
+//
+//      Parameter:  tree is the tree the files are being merged with.
+//
+//      Parameter:  values is the sorted block of ints of the tree's winning file, starting at the
+//                  winning int.
+//
+//      Parameter:  numValues is the number of ints in the block.
+//
+//        Returns:  The number of ints at the start of the block that win against the runner-up.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Tree>
+int winningStretch(const Tree& tree, const int* values, int numValues)
+{
+	// The node holding the first int of all the other files
+	int runnerUp = tree.runnerUp();
+
+	// Gallop until an int that loses to the runner-up is found or the end of the block is passed. After
+	// this, values[lastWin] is known to win and values[firstLoss] is known to lose.
+	int lastWin = 0;
+
+	int step = 1;
+
+	while (lastWin + step < numValues && tree.winnerBeats(values[lastWin + step], runnerUp))
+	{
+		lastWin += step;
+
+		step *= 2;
+	}
+
+	int firstLoss = (lastWin + step < numValues) ? lastWin + step : numValues;
+
+	// Binary search between the last win and the first loss
+	while (firstLoss - lastWin > 1)
+	{
+		int middle = lastWin + (firstLoss - lastWin) / 2;
+
+		if (tree.winnerBeats(values[middle], runnerUp))
+			lastWin = middle;
+		else
+			firstLoss = middle;
+	}
+
+	return firstLoss;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,215 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    OutputWriter.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the OutputWriter class's functions, which write
+//                    the output of a merge behind the merge.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "IndexedFile.h"
+#include "OutputWriter.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  OutputWriter
+//
+//        Purpose:  Opens the output file and allocates the blocks. A file that cannot be opened is
+//                  reported to the backend as a failure, and nothing is written to it.
+//
+//      Parameter:  path is the path of the file to write.
+//
+//      Parameter:  numBlocksToUse is the number of blocks to write through. If it is less than 2, ints
+//                  are written to the file as soon as they are given.
+//
+//      Parameter:  blockSize is the number of ints each block holds.
+//
+//      Parameter:  backend is the backend that writes the blocks.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+OutputWriter::OutputWriter(const std::string& path, int numBlocksToUse, int blockSize, IoBackend& backend)
+	: outFile(path, std::ios::out | std::ios::binary), io(backend), blocks(nullptr), numBlocks(0),
+	blockInts(blockSize), current(0), indexInterval(0), numWritten(0)
+{
+	if (!outFile.is_open())
+		io.fail("Error opening output file " + path + ".");
+
+	if (numBlocksToUse < 2)
+		return;
+
+	numBlocks = numBlocksToUse;
+
+	blocks = new OutputBlock[numBlocks];
+
+	for (int i = 0; i < numBlocks; i++)
+	{
+		blocks[i].values = new int[blockInts];
+
+		blocks[i].count = 0;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~OutputWriter
+//
+//        Purpose:  Finishes writing the file if it has not been closed yet, and deletes the blocks.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+OutputWriter::~OutputWriter()
+{
+	close();
+
+	for (int i = 0; i < numBlocks; i++)
+		delete[] blocks[i].values;
+
+	delete[] blocks;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  buildIndex
+//
+//        Purpose:  Starts building the sidecar index of the file. It must be called before any ints are
+//                  written, and the ints must be written in sorted order.
+//
+//      Parameter:  indexPath is the path of the index file.
+//
+//      Parameter:  interval is the number of ints between two entries of the index.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OutputWriter::buildIndex(const std::string& indexPath, int interval)
+{
+	indexFile.open(indexPath, std::ios::out | std::ios::binary);
+
+	if (!indexFile.is_open())
+	{
+		io.fail("Error opening index file " + indexPath + ".");
+
+		return;
+	}
+
+	indexInterval = interval;
+
+	indexFile.write((const char*)&indexInterval, sizeof(int));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  write
+//
+//        Purpose:  Copies ints into the current block, handing each block off to be written as it fills up.
+//
+//      Parameter:  values is the ints to write.
+//
+//      Parameter:  numValues is the number of ints to write.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OutputWriter::write(const int* values, int numValues)
+{
+	// A file that could not be opened has been reported, and no blocks are handed off for it
+	if (!outFile.is_open())
+		return;
+
+	if (indexInterval > 0)
+	{
+		// The first int written and every indexInterval-th int after it are indexed
+		long long next = (numWritten + indexInterval - 1) / indexInterval * indexInterval;
+
+		for (; next < numWritten + numValues; next += indexInterval)
+			writeIndexEntry(indexFile, values[next - numWritten], next * sizeof(int));
+	}
+
+	numWritten += numValues;
+
+	if (blocks == nullptr)
+	{
+		outFile.write((const char*)values, sizeof(int) * numValues);
+
+		return;
+	}
+
+	while (numValues > 0)
+	{
+		OutputBlock& block = blocks[current];
+
+		int numToCopy = (numValues < blockInts - block.count) ? numValues : blockInts - block.count;
+
+		memcpy(block.values + block.count, values, sizeof(int) * numToCopy);
+
+		block.count += numToCopy;
+
+		values += numToCopy;
+
+		numValues -= numToCopy;
+
+		if (block.count == blockInts)
+			handOff();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  close
+//
+//        Purpose:  Writes the last partly filled block, waits for all the blocks to be written, and closes
+//                  the file and its index. A file that could not be written in full is reported to the
+//                  backend as a failure.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OutputWriter::close()
+{
+	if (!outFile.is_open())
+		return;
+
+	if (blocks != nullptr)
+	{
+		if (blocks[current].count > 0)
+			handOff();
+
+		for (int i = 0; i < numBlocks; i++)
+			io.await(blocks[i].request);
+	}
+
+	outFile.close();
+
+	// The blocks written so far were checked as they were awaited, but the last of them may only have
+	// reached the device when the file was flushed by closing it
+	if (outFile.fail())
+		io.fail("Error writing output file.");
+
+	if (!indexFile.is_open())
+		return;
+
+	indexFile.close();
+
+	if (indexFile.fail())
+		io.fail("Error writing index file.");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  handOff
+//
+//        Purpose:  Starts writing the current block, and moves on to the next block, which was handed off
+//                  longest ago. If that block is still being written, this waits for it to finish.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OutputWriter::handOff()
+{
+	OutputBlock& block = blocks[current];
+
+	io.writeBlock(block.request, outFile, block.values, sizeof(int) * block.count);
+
+	current = (current + 1) % numBlocks;
+
+	io.await(blocks[current].request);
+
+	blocks[current].count = 0;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  OutputWriter.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the OutputWriter class, which writes the output of a merge through
+//                  a set of fixed-size blocks. The merge copies ints into the current block, and each full
+//                  block is written asynchronously while the merge fills the next one. The writer can
+//                  also build the sidecar index of the file as it is written.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <fstream>
+#include <string>
+
+#include "AsyncIo.h"
+
+// A block of ints to be written
+struct OutputBlock
+{
+	int* values;
+
+	int count;
+
+	// The last write of the block that was submitted
+	IoRequest request;
+};
+
+class OutputWriter
+{
+public:
+	OutputWriter(const std::string&, int, int, IoBackend&);
+	~OutputWriter();
+
+	void buildIndex(const std::string&, int);
+	void write(const int*, int);
+	void close();
+
+private:
+	void handOff();
+
+	// The file being written
+	std::ofstream outFile;
+
+	// The backend that writes the blocks
+	IoBackend& io;
+
+	// The blocks, or a null pointer if ints are written to the file as soon as they are given
+	OutputBlock* blocks;
+
+	// The number of blocks
+	int numBlocks;
+
+	// The number of ints each block holds
+	int blockInts;
+
+	// The index of the block being filled by the merge
+	int current;
+
+	// The index being built, if one was asked for
+	std::ofstream indexFile;
+
+	// The number of ints between two entries of the index, or 0 if no index is built
+	int indexInterval;
+
+	// The number of ints given to the writer so far
+	long long numWritten;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,316 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  OvcLoserTree.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the OvcLoserTree class template, a loser tree that uses offset-value
+//                  coding to decide most of its matches without comparing full keys. Each node holds the
+//                  normalized key of its loser along with a code that describes the key relative to the
+//                  key that beat it: the offset of the first byte where the two keys differ, and the
+//                  value of that byte. Every loser on the winner's path lost to the winner, so when the
+//                  winner is replaced by the next key of its file, coded relative to the old winner,
+//                  all of the keys in the replay are coded relative to the same key. Whichever has the
+//                  smaller code comes first, and the loser's code stays correct for the new winner. Full
+//                  keys are only compared when two codes are equal. It can be used in place of LoserTree
+//                  for any order with normalized keys, and counts how many matches each way is used.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef OVCLOSERTREE_H
+#define OVCLOSERTREE_H
+
+// The number of matches an offset-value coded tree decided by codes alone and by comparing full keys
+struct OvcCounters
+{
+	// Matches decided by codes alone, each of which saved a full key comparison
+	long long codeDecisions;
+
+	// Matches where the codes were equal, so the full keys had to be compared
+	long long fullComparisons;
+};
+
+template <class Order>
+class OvcLoserTree
+{
+public:
+	// Plays the initial tournament between the first int of each of numFiles files. Every file must
+	// have at least one int.
+	OvcLoserTree(const int* firstValues, int numFiles, const Order& = Order())
+	{
+		counters.codeDecisions = 0;
+
+		counters.fullComparisons = 0;
+
+		numLeaves = 2;
+
+		while (numLeaves < numFiles)
+			numLeaves *= 2;
+
+		nodeKeys = new unsigned long long[numLeaves];
+
+		nodeCodes = new unsigned int[numLeaves];
+
+		nodeFiles = new int[numLeaves];
+
+		// Play the tournament from the leaves up. Before any match, every key is coded relative to a key
+		// smaller than all keys, whose first byte differs from all of theirs.
+		unsigned long long* winnerKeys = new unsigned long long[numLeaves * 2];
+
+		unsigned int* winnerCodes = new unsigned int[numLeaves * 2];
+
+		int* winnerFiles = new int[numLeaves * 2];
+
+		for (int i = 0; i < numLeaves; i++)
+		{
+			winnerKeys[numLeaves + i] = (i < numFiles) ? normalizedKey(firstValues[i]) : 0;
+
+			winnerCodes[numLeaves + i] = codeAt(winnerKeys[numLeaves + i], 0);
+
+			winnerFiles[numLeaves + i] = (i < numFiles) ? i : exhausted(i);
+		}
+
+		for (int node = numLeaves - 1; node > 0; node--)
+		{
+			int left = node * 2;
+
+			int right = left + 1;
+
+			unsigned int loserCode;
+
+			bool rightWins = match(winnerKeys[right], winnerCodes[right], winnerFiles[right], winnerKeys[left], winnerCodes[left], winnerFiles[left], loserCode);
+
+			int winner = rightWins ? right : left;
+
+			int loser = rightWins ? left : right;
+
+			nodeKeys[node] = winnerKeys[loser];
+
+			nodeCodes[node] = loserCode;
+
+			nodeFiles[node] = winnerFiles[loser];
+
+			winnerKeys[node] = winnerKeys[winner];
+
+			winnerCodes[node] = winnerCodes[winner];
+
+			winnerFiles[node] = winnerFiles[winner];
+		}
+
+		nodeKeys[0] = winnerKeys[1];
+
+		nodeCodes[0] = winnerCodes[1];
+
+		nodeFiles[0] = winnerFiles[1];
+
+		delete[] winnerKeys;
+
+		delete[] winnerCodes;
+
+		delete[] winnerFiles;
+	}
+
+	~OvcLoserTree()
+	{
+		delete[] nodeKeys;
+
+		delete[] nodeCodes;
+
+		delete[] nodeFiles;
+	}
+
+	// Whether every file has run out of ints
+	bool empty() const
+	{
+		return nodeFiles[0] >= numLeaves;
+	}
+
+	// The index of the file with the first current int
+	int winner() const
+	{
+		return nodeFiles[0];
+	}
+
+	// The node holding the first current int of all files other than the winner. Every loser on the
+	// winner's path is coded relative to the winner, so the smallest code is the runner-up unless
+	// several are tied.
+	int runnerUp() const
+	{
+		int runnerUpNode = (numLeaves + nodeFiles[0]) / 2;
+
+		for (int node = runnerUpNode / 2; node > 0; node /= 2)
+		{
+			if (beats(nodeKeys[node], nodeFiles[node], nodeKeys[runnerUpNode], nodeFiles[runnerUpNode]))
+				runnerUpNode = node;
+		}
+
+		return runnerUpNode;
+	}
+
+	// Whether value, as the winner's next int, would still win against the int held at node
+	bool winnerBeats(int value, int node) const
+	{
+		return beats(normalizedKey(value), nodeFiles[0], nodeKeys[node], nodeFiles[node]);
+	}
+
+	// Replaces the winner's int with the next int from the same file, coded relative to the winner, and
+	// replays its matches from its leaf to the root to find the new winner
+	void replaceWinner(int value)
+	{
+		unsigned long long key = normalizedKey(value);
+
+		replay(key, codeRelativeTo(key, nodeKeys[0]), nodeFiles[0]);
+	}
+
+	// Marks the winner's file as having no ints left, and replays its matches to find the new winner
+	void exhaustWinner()
+	{
+		replay(0, 0, exhausted(nodeFiles[0]));
+	}
+
+	// The number of matches decided each way since the tree was created
+	const OvcCounters& ovcCounters() const
+	{
+		return counters;
+	}
+
+private:
+	// The number of bytes in a normalized key
+	static const int NUM_KEY_BYTES = (Order::KEY_BITS + 7) / 8;
+
+	// The normalized key of an int, shifted so that its first byte is the highest byte
+	static unsigned long long normalizedKey(int value)
+	{
+		return Order::key(value) << (64 - Order::KEY_BITS);
+	}
+
+	// The code of a key whose first difference from the key it is coded relative to is at byte offset.
+	// Keys that share more bytes with that key get smaller codes, and keys that differ at the same byte
+	// are ordered by that byte.
+	static unsigned int codeAt(unsigned long long key, int offset)
+	{
+		return (unsigned int)(NUM_KEY_BYTES - offset) * 256 + (unsigned int)((key >> (56 - offset * 8)) & 0xFF);
+	}
+
+	// The code of a key relative to a key that comes before or is equal to it, which is 0 if the keys are
+	// equal
+	static unsigned int codeRelativeTo(unsigned long long key, unsigned long long base)
+	{
+		unsigned long long difference = key ^ base;
+
+		if (difference == 0)
+			return 0;
+
+		int offset = 0;
+
+		while ((difference >> (56 - offset * 8)) == 0)
+			offset++;
+
+		return codeAt(key, offset);
+	}
+
+	// The file index stored for a file that has no ints left. It is larger than every file index, so
+	// it loses to every file that has ints left.
+	int exhausted(int file) const
+	{
+		return numLeaves + file;
+	}
+
+	// Whether key a from file aFile comes before key b from file bFile, breaking ties by file index
+	bool beats(unsigned long long a, int aFile, unsigned long long b, int bFile) const
+	{
+		if ((aFile | bFile) >= numLeaves)
+			return aFile < bFile;
+
+		return a < b || (a == b && aFile < bFile);
+	}
+
+	// Plays a match between two keys coded relative to the same key. Returns whether a wins, and sets
+	// loserCode to the loser's code relative to the winner.
+	bool match(unsigned long long a, unsigned int aCode, int aFile, unsigned long long b, unsigned int bCode, int bFile, unsigned int& loserCode)
+	{
+		bool aWins;
+
+		if ((aFile | bFile) >= numLeaves)
+		{
+			aWins = aFile < bFile;
+
+			loserCode = aWins ? bCode : aCode;
+		}
+		else if (aCode != bCode)
+		{
+			counters.codeDecisions++;
+
+			aWins = aCode < bCode;
+
+			loserCode = aWins ? bCode : aCode;
+		}
+		else
+		{
+			counters.fullComparisons++;
+
+			aWins = beats(a, aFile, b, bFile);
+
+			loserCode = aWins ? codeRelativeTo(b, a) : codeRelativeTo(a, b);
+		}
+
+		return aWins;
+	}
+
+	// Replays the winner's matches from its leaf to the root with the given key, code, and file index
+	void replay(unsigned long long key, unsigned int code, int file)
+	{
+		for (int node = (numLeaves + (file & (numLeaves - 1))) / 2; node > 0; node /= 2)
+		{
+			unsigned int loserCode;
+
+			// If the loser stored at this node wins the rematch, the two trade places
+			if (match(nodeKeys[node], nodeCodes[node], nodeFiles[node], key, code, file, loserCode))
+			{
+				unsigned long long winnerKey = nodeKeys[node];
+
+				unsigned int winnerCode = nodeCodes[node];
+
+				int winnerFile = nodeFiles[node];
+
+				nodeKeys[node] = key;
+
+				nodeFiles[node] = file;
+
+				key = winnerKey;
+
+				code = winnerCode;
+
+				file = winnerFile;
+			}
+
+			nodeCodes[node] = loserCode;
+		}
+
+		nodeKeys[0] = key;
+
+		nodeCodes[0] = code;
+
+		nodeFiles[0] = file;
+	}
+
+	// The number of matches decided each way
+	OvcCounters counters;
+
+	// The number of leaves in the tree, which is the number of files rounded up to a power of two
+	int numLeaves;
+
+	// The normalized key of the loser of each node's match, with the winner's key at index 0
+	unsigned long long* nodeKeys;
+
+	// The code of the loser of each node's match relative to the key that beat it
+	unsigned int* nodeCodes;
+
+	// The index of the file that lost each node's match, with the winner's file index at index 0. Files
+	// with no ints left are stored as their index plus numLeaves.
+	int* nodeFiles;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,302 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  Prefetcher.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the Prefetcher class template, which reads blocks of ints from the
+//                  files being merged. It keeps a small pool of spare buffers, and the next block of a
+//                  file is read asynchronously into a spare buffer before the file's current block runs
+//                  out. The file whose current block ends with the int that comes first in the sort
+//                  order will run out first, so that is the file whose next block is read first. As long
+//                  as the reads keep up, the merge never has to wait for one.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <vector>
+
+#include "AsyncIo.h"
+#include "FileInteger.h"
+
+template <class Order>
+class Prefetcher
+{
+public:
+	Prefetcher(const std::vector<FileInteger*>&, int, IoBackend&, const Order& = Order());
+	~Prefetcher();
+
+	bool nextBlock(FileInteger*);
+
+private:
+	void readBlock(FileInteger*);
+	void updateForecast(FileInteger*);
+	bool runsOutFirst(int, int) const;
+	void requestPrefetches();
+
+	// The files being merged
+	std::vector<FileInteger*> files;
+
+	// Buffers that are not in use by any file
+	std::vector<int*> spareBuffers;
+
+	// The number of leaves in the forecast tree, which is the number of files rounded up to a power of two
+	int numLeaves;
+
+	// The order the files are merged in
+	Order order;
+
+	// The last buffered int of each file
+	std::vector<int> forecastValues;
+
+	// Whether each file has more to read and does not have its next block requested yet
+	std::vector<char> canPrefetch;
+
+	// Tournament tree in which each node holds the index of the file in its subtree whose buffer will
+	// run out first, out of the files that can prefetch, so forecastTree[1] is the next file to prefetch
+	std::vector<int> forecastTree;
+
+	// The backend that reads the blocks ahead of time
+	IoBackend& io;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  Prefetcher
+//
+//        Purpose:  Reads the first block of every file being merged, then starts reading ahead.
+//
+//      Parameter:  filesToMerge holds the files being merged. Each one must have its file open, its
+//                  buffer allocated, and its number of ints left to read set.
+//
+//      Parameter:  numSpareBuffers is the number of extra buffers, each the size of a file's buffer,
+//                  that blocks can be read ahead into. If it is 0, blocks are only read when needed.
+//
+//      Parameter:  backend is the backend that reads the blocks ahead of time.
+//
+//      Parameter:  sortOrder is the order the files are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+Prefetcher<Order>::Prefetcher(const std::vector<FileInteger*>& filesToMerge, int numSpareBuffers, IoBackend& backend, const Order& sortOrder)
+	: files(filesToMerge), order(sortOrder), io(backend)
+{
+	numLeaves = 1;
+
+	while (numLeaves < (int)files.size())
+		numLeaves *= 2;
+
+	forecastValues.assign(numLeaves, 0);
+
+	canPrefetch.assign(numLeaves, 0);
+
+	forecastTree.assign(numLeaves * 2, 0);
+
+	for (int i = 0; i < numLeaves; i++)
+		forecastTree[numLeaves + i] = i;
+
+	for (int node = numLeaves - 1; node > 0; node--)
+		forecastTree[node] = forecastTree[node * 2];
+
+	for (int i = 0; i < (int)files.size(); i++)
+	{
+		files[i]->fileIndex = i;
+
+		files[i]->prefetchBuffer = nullptr;
+
+		readBlock(files[i]);
+
+		updateForecast(files[i]);
+	}
+
+	if (numSpareBuffers > 0 && files.size() > 0)
+	{
+		for (int i = 0; i < numSpareBuffers; i++)
+			spareBuffers.push_back(new int[files[0]->bufferCapacity]);
+
+		requestPrefetches();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ~Prefetcher
+//
+//        Purpose:  Waits for any blocks still being read, and deletes the spare buffers.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+Prefetcher<Order>::~Prefetcher()
+{
+	for (int i = 0; i < (int)files.size(); i++)
+	{
+		io.await(files[i]->prefetchRequest);
+
+		if (files[i]->prefetchBuffer != nullptr)
+			spareBuffers.push_back(files[i]->prefetchBuffer);
+
+		files[i]->prefetchBuffer = nullptr;
+	}
+
+	for (int i = 0; i < (int)spareBuffers.size(); i++)
+		delete[] spareBuffers[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  nextBlock
+//
+//        Purpose:  Replaces the used up buffer of a file with the file's next block of ints. If the block
+//                  was read ahead of time, the buffers are swapped. If it is still being read, this waits
+//                  for it. If it was never requested, it is read right away.
+//
+//      Parameter:  fi is the file whose buffer has been used up.
+//
+//        Returns:  True if the file had another block, or false if there were no ints left in the file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool Prefetcher<Order>::nextBlock(FileInteger* fi)
+{
+	if (fi->prefetchBuffer == nullptr)
+	{
+		if (fi->numLeftToRead <= 0)
+			return false;
+
+		readBlock(fi);
+	}
+	else
+	{
+		io.await(fi->prefetchRequest);
+
+		// The used up buffer becomes a spare, and the prefetched block becomes the current block
+		spareBuffers.push_back(fi->buffer);
+
+		fi->buffer = fi->prefetchBuffer;
+
+		fi->bufferLen = fi->prefetchLen;
+
+		fi->bufferPos = 0;
+
+		fi->value = fi->buffer[0];
+
+		fi->prefetchBuffer = nullptr;
+	}
+
+	updateForecast(fi);
+
+	requestPrefetches();
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readBlock
+//
+//        Purpose:  Reads the next block of ints from a file into its buffer right away, and sets its
+//                  value to the first int in the block.
+//
+//      Parameter:  fi is the file to read from. It must have ints left to read.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void Prefetcher<Order>::readBlock(FileInteger* fi)
+{
+	int numToRead = (fi->numLeftToRead < fi->bufferCapacity) ? (int)fi->numLeftToRead : fi->bufferCapacity;
+
+	fi->ptrFileReadFrom->read((char*)fi->buffer, numToRead * sizeof(int));
+
+	fi->numLeftToRead -= numToRead;
+
+	fi->bufferLen = numToRead;
+
+	fi->bufferPos = 0;
+
+	fi->value = fi->buffer[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  updateForecast
+//
+//        Purpose:  Updates a file's forecast key after its buffer or its requests have changed, and
+//                  replays the matches on its path to the root of the forecast tree.
+//
+//      Parameter:  fi is the file to update.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void Prefetcher<Order>::updateForecast(FileInteger* fi)
+{
+	canPrefetch[fi->fileIndex] = fi->prefetchBuffer == nullptr && fi->numLeftToRead > 0;
+
+	forecastValues[fi->fileIndex] = fi->buffer[fi->bufferLen - 1];
+
+	for (int node = (numLeaves + fi->fileIndex) / 2; node > 0; node /= 2)
+	{
+		int left = forecastTree[node * 2];
+
+		int right = forecastTree[node * 2 + 1];
+
+		forecastTree[node] = runsOutFirst(right, left) ? right : left;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  runsOutFirst
+//
+//        Purpose:  Determines whether one file should have its next block read before another.
+//
+//      Parameter:  a is the index of the first file.
+//
+//      Parameter:  b is the index of the second file.
+//
+//        Returns:  True if file a can prefetch and will run out of buffered ints before file b, or file
+//                  b cannot prefetch.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool Prefetcher<Order>::runsOutFirst(int a, int b) const
+{
+	if (!canPrefetch[b])
+		return canPrefetch[a] != 0;
+
+	return canPrefetch[a] && order(forecastValues[a], forecastValues[b]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  requestPrefetches
+//
+//        Purpose:  Hands out the spare buffers to the files whose buffers will run out soonest, and starts
+//                  reading their next blocks into them.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void Prefetcher<Order>::requestPrefetches()
+{
+	while (!spareBuffers.empty() && canPrefetch[forecastTree[1]])
+	{
+		FileInteger* fi = files[forecastTree[1]];
+
+		fi->prefetchBuffer = spareBuffers.back();
+
+		spareBuffers.pop_back();
+
+		fi->prefetchLen = (fi->numLeftToRead < fi->bufferCapacity) ? (int)fi->numLeftToRead : fi->bufferCapacity;
+
+		fi->numLeftToRead -= fi->prefetchLen;
+
+		updateForecast(fi);
+
+		io.readBlock(fi->prefetchRequest, *fi->ptrFileReadFrom, fi->prefetchBuffer, fi->prefetchLen * sizeof(int));
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,185 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    Progress.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the ProgressTracker class's functions, which
+//                    keep count of how far a sort has gotten and report it to a callback.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Progress.h"
+
+// The number of bytes processed between two readings of the clock
+static const long long CHECK_BYTES = 1024 * 1024;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  ProgressTracker
+//
+//        Purpose:  Creates a tracker that reports to a callback.
+//
+//      Parameter:  callbackToUse is the function given the events.
+//
+//      Parameter:  callbackContext is passed to the callback with each event.
+//
+//      Parameter:  intervalSeconds is the least time between two events in the middle of a pass.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+ProgressTracker::ProgressTracker(ProgressCallback callbackToUse, void* callbackContext, double intervalSeconds)
+	: callback(callbackToUse), context(callbackContext), interval(intervalSeconds), phase(""), pass(0),
+	numPasses(1), passBytes(0), passBytesDone(0), nextCheck(CHECK_BYTES)
+{
+	startTime = std::chrono::steady_clock::now();
+
+	lastReport = startTime;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  start
+//
+//        Purpose:  Starts timing a sort. No event is reported until its first pass begins.
+//
+//      Parameter:  inputBytes is the size of the input, which is the number of bytes each pass processes.
+//
+//      Parameter:  expectedPasses is the number of passes the sort is expected to make, which can be
+//                  changed with expectPasses once it is better known.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::start(long long inputBytes, int expectedPasses)
+{
+	startTime = std::chrono::steady_clock::now();
+
+	lastReport = startTime;
+
+	passBytes = inputBytes;
+
+	numPasses = expectedPasses;
+
+	pass = 0;
+
+	passBytesDone = 0;
+
+	nextCheck = CHECK_BYTES;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  beginPass
+//
+//        Purpose:  Starts the next pass over the data, and reports it. If the sort makes more passes
+//                  than were expected, such as when memory pressure lowers the fan-in, the number
+//                  expected is raised to match.
+//
+//      Parameter:  passPhase is the phase the pass belongs to.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::beginPass(const char* passPhase)
+{
+	pass++;
+
+	if (pass > numPasses)
+		numPasses = pass;
+
+	passBytesDone = 0;
+
+	nextCheck = CHECK_BYTES;
+
+	report(passPhase);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  expectPasses
+//
+//        Purpose:  Sets the number of passes the sort is expected to make, once the merge shape is known.
+//
+//      Parameter:  expectedPasses is the number of passes, including those already made.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::expectPasses(int expectedPasses)
+{
+	numPasses = (expectedPasses > pass) ? expectedPasses : pass;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  finish
+//
+//        Purpose:  Reports that the sort is done.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::finish()
+{
+	numPasses = pass;
+
+	passBytesDone = passBytes;
+
+	report("done");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  check
+//
+//        Purpose:  Reads the clock, and reports the progress of the pass if the interval has gone by since
+//                  the last event.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::check()
+{
+	nextCheck = passBytesDone + CHECK_BYTES;
+
+	if (std::chrono::steady_clock::now() - lastReport >= interval)
+		report(phase);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  report
+//
+//        Purpose:  Hands the progress of the sort to the callback. The time left is estimated from the
+//                  rate the bytes of all passes so far have been processed at, since every pass processes
+//                  the whole input.
+//
+//      Parameter:  eventPhase is the phase to report, which becomes the current phase.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ProgressTracker::report(const char* eventPhase)
+{
+	phase = eventPhase;
+
+	lastReport = std::chrono::steady_clock::now();
+
+	std::chrono::duration<double> elapsed = lastReport - startTime;
+
+	// A merge that takes files from the end of one pass and the start of the next is counted in the
+	// first, so a pass can count a little more than the input
+	long long bytesInPass = (passBytesDone < passBytes) ? passBytesDone : passBytes;
+
+	double bytesDone = (double)passBytes * (pass - 1) + bytesInPass;
+
+	double totalBytes = (double)passBytes * numPasses;
+
+	ProgressEvent event;
+
+	event.phase = phase;
+
+	event.pass = pass;
+
+	event.numPasses = numPasses;
+
+	event.passBytesDone = bytesInPass;
+
+	event.passBytes = passBytes;
+
+	event.elapsedSeconds = elapsed.count();
+
+	event.remainingSeconds = (bytesDone > 0) ? elapsed.count() * (totalBytes - bytesDone) / bytesDone : -1;
+
+	callback(event, context);
+}
\ No newline at end of file
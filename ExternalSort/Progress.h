@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  Progress.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the ProgressEvent struct and the ProgressTracker class, which let a
+//                  caller follow a long sort. The sort tells the tracker when it starts a pass over the
+//                  data and how many bytes each block it sorts or merges holds, and the tracker hands a
+//                  ProgressEvent to the caller's callback at the start of each pass and every so often
+//                  in between. Every stage of the sort runs on the thread that started it, so the counts
+//                  are plain numbers, and the clock is only read once a megabyte or so has gone by.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <chrono>
+
+// How far a sort has gotten
+struct ProgressEvent
+{
+	// "runs" while the input is sorted into runs, "merge" while runs are merged, or "done"
+	const char* phase;
+
+	// The pass over the data being made, counting from 1, and the number of passes expected. Sorting
+	// into runs is the first pass of a sort, and each level of merges is another.
+	int pass;
+
+	int numPasses;
+
+	// The bytes the pass has sorted or merged so far, and the bytes it will in all
+	long long passBytesDone;
+
+	long long passBytes;
+
+	// The seconds since the sort started, and the seconds it is expected to take to finish, or -1 if
+	// nothing has been processed yet to estimate from
+	double elapsedSeconds;
+
+	double remainingSeconds;
+};
+
+// A function that is given each progress event, along with the context it was registered with
+typedef void (*ProgressCallback)(const ProgressEvent&, void*);
+
+class ProgressTracker
+{
+public:
+	ProgressTracker(ProgressCallback, void*, double);
+
+	void start(long long, int);
+	void beginPass(const char*);
+	void expectPasses(int);
+	void finish();
+
+	// Counts bytes that have been sorted or merged. This is called for every stretch of ints a merge
+	// hands out, so it only adds them up until enough have gone by to be worth reading the clock.
+	void advance(long long numBytes)
+	{
+		passBytesDone += numBytes;
+
+		if (passBytesDone >= nextCheck)
+			check();
+	}
+
+private:
+	void check();
+	void report(const char*);
+
+	// The function given the events, and the context passed to it
+	ProgressCallback callback;
+
+	void* context;
+
+	// The least time between two events in the middle of a pass
+	std::chrono::duration<double> interval;
+
+	// When the sort started, and when the last event was reported
+	std::chrono::steady_clock::time_point startTime;
+
+	std::chrono::steady_clock::time_point lastReport;
+
+	// The current phase, pass, and number of passes expected
+	const char* phase;
+
+	int pass;
+
+	int numPasses;
+
+	// The bytes each pass processes, which is the size of the input
+	long long passBytes;
+
+	// The bytes the current pass has processed
+	long long passBytesDone;
+
+	// The number of bytes processed at which the clock is next read
+	long long nextCheck;
+};
+
+#endif
\ No newline at end of file
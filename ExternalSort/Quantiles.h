@@ -0,0 +1,512 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  Quantiles.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the quantile search, which finds exact quantiles of a file by
+//                  selection instead of sorting it. A sampling pass reads the file and keeps a random
+//                  sample of its ints, and two pivots that bracket each quantile are picked from the
+//                  sorted sample. A counting pass then reads the file again, counting the ints before each
+//                  bracket and keeping only the ints inside it, and the quantile is selected from those.
+//                  No temp files are written. If a bracket misses its quantile or holds more ints than
+//                  fit in memory, which the sample makes unlikely, the search is repeated within the
+//                  part of the file that is known to hold the quantile.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUANTILES_H
+#define QUANTILES_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SortOptions.h"
+
+// A range of ints in an order. Either end can be left open, and both ends are included in the range.
+struct IntRange
+{
+	bool hasLow;
+
+	int low;
+
+	bool hasHigh;
+
+	int high;
+};
+
+// A quantile being searched for
+struct QuantileTarget
+{
+	// The position of the quantile in the file once sorted
+	long long rank;
+
+	// Whether the quantile has been found
+	bool found;
+
+	// The quantile, once it has been found
+	int value;
+
+	// The ints the quantile is known to be among
+	IntRange region;
+
+	// The number of ints of the file that come before the region
+	long long numBeforeRegion;
+
+	// The number of ints of the file in the region
+	long long numInRegion;
+
+	// The ints sampled from the region
+	std::vector<int> sample;
+
+	// The position in the region of the next int to put in the sample, once the sample is full
+	long long nextSampled;
+
+	// The weight that the gaps between sampled ints are drawn with
+	double sampleWeight;
+
+	// The pivots picked from the sample
+	IntRange bracket;
+
+	// The number of ints of the file that come before the bracket, are equal to its low end, are
+	// strictly inside it, and are equal to its high end
+	long long numBefore;
+
+	long long numEqualLow;
+
+	long long numInside;
+
+	long long numEqualHigh;
+
+	// The ints strictly inside the bracket, if they all fit in memory
+	std::vector<int> inside;
+};
+
+template <class Order> std::vector<int> findQuantiles(const std::string&, const std::vector<double>&, const SortOptions&, const Order&);
+template <class Order> void scanFile(std::ifstream&, long long, std::vector<QuantileTarget>&, bool, int, int, std::mt19937_64&, const Order&);
+template <class Order> void sampleInt(QuantileTarget&, int, int, std::mt19937_64&, const Order&);
+template <class Order> void countInt(QuantileTarget&, int, int, const Order&);
+template <class Order> void pickBracket(QuantileTarget&, const Order&);
+template <class Order> void resolveQuantile(QuantileTarget&, int, const Order&);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  findQuantiles
+//
+//        Purpose:  Finds quantiles of a file without sorting it. Each round reads the file twice, once to
+//                  sample it and once to count and keep the ints inside the brackets, and nearly always
+//                  finds every quantile in the first round.
+//
+//      Parameter:  path is the path of the file. The program exits if it cannot be opened, is empty, or
+//                  the memory limit is too small for the number of quantiles.
+//
+//      Parameter:  fractions holds the quantiles to find, each between 0 and 1. The quantile for a
+//                  fraction q of a file of n ints is the int at position ceil(q * n) - 1 once the file is
+//                  sorted, or the first int if q is 0.
+//
+//      Parameter:  options holds the maximum number of integers allowed in memory simultaneously.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//        Returns:  The quantiles, in the order of the fractions.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+std::vector<int> findQuantiles(const std::string& path, const std::vector<double>& fractions, const SortOptions& options, const Order& order)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		std::cout << "Error opening input file " << path << "." << std::endl;
+		exit(0);
+	}
+
+	file.seekg(0, std::ios::end);
+
+	long long numInts = (long long)file.tellg() / sizeof(int);
+
+	if (numInts == 0)
+	{
+		std::cout << "The file " << path << " has no ints." << std::endl;
+		exit(0);
+	}
+
+	// A quarter of the memory holds the blocks of the file as they are read, and the rest is split
+	// between the samples and the brackets of the quantiles
+	int blockInts = (options.maxFileInts / 4 > 0) ? options.maxFileInts / 4 : 1;
+
+	int quantileInts = (options.maxFileInts - blockInts) / (int)fractions.size();
+
+	// Fewer ints than this would make the brackets too wide to narrow the search down each round
+	const int MIN_SAMPLE_INTS = 16;
+
+	if (quantileInts < MIN_SAMPLE_INTS * 2)
+	{
+		std::cout << "Must allow at least " << MIN_SAMPLE_INTS * 2 * fractions.size() * 4 / 3 + 4
+			<< " ints in memory simultaneously to find " << fractions.size() << " quantiles." << std::endl;
+		exit(0);
+	}
+
+	// A bracket of a sample of s ints holds about 6n / sqrt(s) of the file's n ints, so the sample only
+	// needs to be big enough for that to fit in the rest of the memory, and is kept no bigger, since it
+	// has to be sorted. Half the memory for the bracket leaves a margin for an unlucky sample.
+	double neededSample = 8.0 * numInts / (quantileInts / 2);
+
+	neededSample *= neededSample;
+
+	int sampleInts = (neededSample < quantileInts / 2) ? (int)neededSample : quantileInts / 2;
+
+	if (sampleInts < MIN_SAMPLE_INTS)
+		sampleInts = MIN_SAMPLE_INTS;
+
+	int insideInts = quantileInts - sampleInts;
+
+	std::vector<QuantileTarget> targets(fractions.size());
+
+	for (int i = 0; i < (int)targets.size(); i++)
+	{
+		long long rank = (long long)std::ceil(fractions[i] * numInts) - 1;
+
+		targets[i].rank = (rank < 0) ? 0 : (rank >= numInts ? numInts - 1 : rank);
+
+		targets[i].found = false;
+
+		targets[i].region.hasLow = false;
+
+		targets[i].region.hasHigh = false;
+	}
+
+	// The sample is drawn the same way every time, so the same file always takes the same passes
+	std::mt19937_64 random(numInts);
+
+	bool allFound = false;
+
+	while (!allFound)
+	{
+		scanFile(file, numInts, targets, true, sampleInts, blockInts, random, order);
+
+		for (int i = 0; i < (int)targets.size(); i++)
+		{
+			if (!targets[i].found)
+				pickBracket(targets[i], order);
+		}
+
+		scanFile(file, numInts, targets, false, insideInts, blockInts, random, order);
+
+		allFound = true;
+
+		for (int i = 0; i < (int)targets.size(); i++)
+		{
+			if (!targets[i].found)
+				resolveQuantile(targets[i], insideInts, order);
+
+			allFound = allFound && targets[i].found;
+		}
+	}
+
+	file.close();
+
+	std::vector<int> quantiles;
+
+	for (int i = 0; i < (int)targets.size(); i++)
+		quantiles.push_back(targets[i].value);
+
+	return quantiles;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  scanFile
+//
+//        Purpose:  Reads the file from start to end once, and either samples each quantile's region or
+//                  counts the ints around each quantile's bracket. Quantiles that have been found are
+//                  skipped.
+//
+//      Parameter:  file is the file, already open.
+//
+//      Parameter:  numInts is the number of ints in the file.
+//
+//      Parameter:  targets holds the quantiles being searched for.
+//
+//      Parameter:  sampling is true for a sampling pass, or false for a counting pass.
+//
+//      Parameter:  maxKept is the number of ints each quantile can keep in memory.
+//
+//      Parameter:  blockInts is the number of ints read from the file at a time.
+//
+//      Parameter:  random is the random number generator the sample is drawn with.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void scanFile(std::ifstream& file, long long numInts, std::vector<QuantileTarget>& targets, bool sampling, int maxKept, int blockInts, std::mt19937_64& random, const Order& order)
+{
+	for (int i = 0; i < (int)targets.size(); i++)
+	{
+		QuantileTarget& target = targets[i];
+
+		target.numBeforeRegion = target.numInRegion = 0;
+
+		target.numBefore = target.numEqualLow = target.numInside = target.numEqualHigh = 0;
+
+		target.sample.clear();
+
+		target.inside.clear();
+	}
+
+	file.clear();
+
+	file.seekg(0, std::ios::beg);
+
+	int* block = new int[blockInts];
+
+	for (long long numLeft = numInts; numLeft > 0;)
+	{
+		int numToRead = (numLeft < blockInts) ? (int)numLeft : blockInts;
+
+		file.read((char*)block, numToRead * sizeof(int));
+
+		numLeft -= numToRead;
+
+		for (int i = 0; i < (int)targets.size(); i++)
+		{
+			if (targets[i].found)
+				continue;
+
+			for (int j = 0; j < numToRead; j++)
+			{
+				if (sampling)
+					sampleInt(targets[i], block[j], maxKept, random, order);
+				else
+					countInt(targets[i], block[j], maxKept, order);
+			}
+		}
+	}
+
+	delete[] block;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sampleInt
+//
+//        Purpose:  Counts an int toward the region of a quantile or the ints before it, and adds it to
+//                  the region's sample if it is drawn. The sample is a reservoir sample, so every int of
+//                  the region is equally likely to be in it. Once the sample is full, the gaps between
+//                  the ints that replace a random int of the sample are drawn directly, so only the ints
+//                  that are drawn cost a random number.
+//
+//      Parameter:  target is the quantile.
+//
+//      Parameter:  value is the int.
+//
+//      Parameter:  sampleInts is the number of ints in a full sample.
+//
+//      Parameter:  random is the random number generator the sample is drawn with.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void sampleInt(QuantileTarget& target, int value, int sampleInts, std::mt19937_64& random, const Order& order)
+{
+	const IntRange& region = target.region;
+
+	if (region.hasLow && order(value, region.low))
+	{
+		target.numBeforeRegion++;
+
+		return;
+	}
+
+	if (region.hasHigh && order(region.high, value))
+		return;
+
+	long long position = target.numInRegion++;
+
+	// Draws are taken from (0, 1], so their logarithms are finite
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+	if (position < sampleInts)
+	{
+		target.sample.push_back(value);
+
+		if (position + 1 == sampleInts)
+		{
+			target.sampleWeight = std::exp(std::log(1 - uniform(random)) / sampleInts);
+
+			target.nextSampled = position + 1 + (long long)std::floor(std::log(1 - uniform(random)) / std::log(1 - target.sampleWeight));
+		}
+	}
+	else if (position == target.nextSampled)
+	{
+		target.sample[std::uniform_int_distribution<int>(0, sampleInts - 1)(random)] = value;
+
+		target.sampleWeight *= std::exp(std::log(1 - uniform(random)) / sampleInts);
+
+		target.nextSampled = position + 1 + (long long)std::floor(std::log(1 - uniform(random)) / std::log(1 - target.sampleWeight));
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  countInt
+//
+//        Purpose:  Counts an int by where it falls relative to the bracket of a quantile, and keeps it if
+//                  it is strictly inside the bracket and there is room.
+//
+//      Parameter:  target is the quantile.
+//
+//      Parameter:  value is the int.
+//
+//      Parameter:  maxInside is the number of ints inside the bracket that can be kept.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void countInt(QuantileTarget& target, int value, int maxInside, const Order& order)
+{
+	const IntRange& bracket = target.bracket;
+
+	if (bracket.hasLow && order(value, bracket.low))
+		target.numBefore++;
+	else if (bracket.hasLow && !order(bracket.low, value))
+		target.numEqualLow++;
+	else if (bracket.hasHigh && order(bracket.high, value))
+		return;
+	else if (bracket.hasHigh && !order(value, bracket.high))
+		target.numEqualHigh++;
+	else
+	{
+		if (target.numInside++ < maxInside)
+			target.inside.push_back(value);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  pickBracket
+//
+//        Purpose:  Sorts the sample of a quantile's region and picks the ints a few standard deviations
+//                  on either side of where the quantile is expected to be in it as the bracket. An end
+//                  that would fall outside the sample is left at the end of the region. The bracket never
+//                  spans more than half the sample, so each round narrows the search even when the
+//                  sample is small.
+//
+//      Parameter:  target is the quantile.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void pickBracket(QuantileTarget& target, const Order& order)
+{
+	std::vector<int>& sample = target.sample;
+
+	std::sort(sample.begin(), sample.end(), order);
+
+	int sampleSize = (int)sample.size();
+
+	double expected = (double)(target.rank - target.numBeforeRegion) * sampleSize / target.numInRegion;
+
+	double spread = 3 * std::sqrt((double)sampleSize) + 1;
+
+	if (spread > sampleSize / 4.0)
+		spread = sampleSize / 4.0;
+
+	long long lowIndex = (long long)std::floor(expected - spread);
+
+	long long highIndex = (long long)std::ceil(expected + spread);
+
+	target.bracket = target.region;
+
+	if (lowIndex >= 0)
+	{
+		target.bracket.hasLow = true;
+
+		target.bracket.low = sample[lowIndex];
+	}
+
+	if (highIndex < sampleSize)
+	{
+		target.bracket.hasHigh = true;
+
+		target.bracket.high = sample[highIndex];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  resolveQuantile
+//
+//        Purpose:  Finds a quantile from the counts around its bracket. If the quantile is equal to an end
+//                  of the bracket, that end is the quantile. If it is strictly inside and the ints inside
+//                  were all kept, it is selected from them. Otherwise, the quantile's region is narrowed
+//                  to the part of it the quantile is now known to be in, for the next round.
+//
+//      Parameter:  target is the quantile.
+//
+//      Parameter:  maxInside is the number of ints inside the bracket that could be kept.
+//
+//      Parameter:  order is the order that the file would be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void resolveQuantile(QuantileTarget& target, int maxInside, const Order& order)
+{
+	long long position = target.rank - target.numBefore;
+
+	if (position < 0)
+	{
+		// The quantile comes before the bracket
+		target.region.hasHigh = true;
+
+		target.region.high = target.bracket.low;
+	}
+	else if (position < target.numEqualLow)
+	{
+		target.found = true;
+
+		target.value = target.bracket.low;
+	}
+	else if ((position -= target.numEqualLow) < target.numInside)
+	{
+		if (target.numInside > maxInside)
+		{
+			target.region = target.bracket;
+
+			return;
+		}
+
+		std::nth_element(target.inside.begin(), target.inside.begin() + position, target.inside.end(), order);
+
+		target.found = true;
+
+		target.value = target.inside[position];
+	}
+	else if ((position -= target.numInside) < target.numEqualHigh)
+	{
+		target.found = true;
+
+		target.value = target.bracket.high;
+	}
+	else
+	{
+		// The quantile comes after the bracket
+		target.region.hasLow = true;
+
+		target.region.low = target.bracket.high;
+	}
+}
+
+#endif
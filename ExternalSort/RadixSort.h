@@ -0,0 +1,288 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  RadixSort.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains an MSD radix sort over the normalized keys that the order policies
+//                  in SortOrder.h give ints. The ints are split into 256 buckets by the highest byte of
+//                  their keys, and each bucket is split again by the next byte, until the buckets are
+//                  small enough to finish with an insertion sort. A key is computed from its int with a
+//                  couple of instructions, so unlike a radix sort over strings, no keys are cached. The
+//                  normal sort moves the ints between buckets in place, and the stable sort distributes
+//                  them through a scratch buffer in their original order.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <cstring>
+
+// Buckets with at most this many ints are sorted with an insertion sort instead of being split further
+const int RADIX_INSERTION_SORT_MAX = 48;
+
+template <class Order> void radixSort(int*, int, bool);
+template <class Order> void radixSortInPlace(int*, int, int);
+template <class Order> void radixSortStable(int*, int*, int, int);
+template <class Order> bool countDigits(const int*, int, int, int*);
+template <class Order> void insertionSortByKey(int*, int);
+template <class Order> unsigned int keyDigit(int, int);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  radixSort
+//
+//        Purpose:  Sorts ints in the order given by an order policy that has normalized keys.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  stable is true if ints with equal keys must keep their order. This takes a scratch
+//                  buffer as large as the array.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void radixSort(int* values, int count, bool stable)
+{
+	if (stable)
+	{
+		int* scratch = new int[count];
+
+		radixSortStable<Order>(values, scratch, count, 0);
+
+		delete[] scratch;
+	}
+	else
+		radixSortInPlace<Order>(values, count, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  radixSortInPlace
+//
+//        Purpose:  Sorts ints whose keys all share the bytes before a given byte. The ints are counted
+//                  by that byte of their keys, then each int is swapped directly into the next free slot
+//                  of its bucket, and the ints it displaces are placed the same way, until every bucket
+//                  is filled. Each bucket is then sorted by the next byte.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  digit is the index of the key byte to split the ints by, starting at 0 for the
+//                  highest byte.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void radixSortInPlace(int* values, int count, int digit)
+{
+	const int NUM_DIGITS = (Order::KEY_BITS + 7) / 8;
+
+	// Once every byte has been used, all of the ints left in the bucket have equal keys
+	for (; digit < NUM_DIGITS; digit++)
+	{
+		if (count <= RADIX_INSERTION_SORT_MAX)
+		{
+			insertionSortByKey<Order>(values, count);
+
+			return;
+		}
+
+		int counts[256];
+
+		// If every int has the same byte, there is nothing to move, so move on to the next byte
+		if (!countDigits<Order>(values, count, digit, counts))
+			continue;
+
+		int next[256], end[256];
+
+		for (int bucket = 0, start = 0; bucket < 256; bucket++)
+		{
+			next[bucket] = start;
+
+			start += counts[bucket];
+
+			end[bucket] = start;
+		}
+
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			while (next[bucket] < end[bucket])
+			{
+				int value = values[next[bucket]];
+
+				unsigned int valueBucket = keyDigit<Order>(value, digit);
+
+				// Swap the int into its bucket, and keep going with the int it displaced, until an
+				// int that belongs in this bucket is found
+				while (valueBucket != (unsigned int)bucket)
+				{
+					int displaced = values[next[valueBucket]];
+
+					values[next[valueBucket]++] = value;
+
+					value = displaced;
+
+					valueBucket = keyDigit<Order>(value, digit);
+				}
+
+				values[next[bucket]++] = value;
+			}
+		}
+
+		for (int bucket = 0, start = 0; bucket < 256; start += counts[bucket], bucket++)
+		{
+			if (counts[bucket] > 1)
+				radixSortInPlace<Order>(values + start, counts[bucket], digit + 1);
+		}
+
+		return;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  radixSortStable
+//
+//        Purpose:  Sorts ints whose keys all share the bytes before a given byte, keeping ints with
+//                  equal keys in order. The ints are counted by that byte of their keys, copied into
+//                  their buckets in the scratch buffer in their original order, and copied back. Each
+//                  bucket is then sorted by the next byte.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  scratch is a buffer that can hold count ints.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  digit is the index of the key byte to split the ints by, starting at 0 for the
+//                  highest byte.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void radixSortStable(int* values, int* scratch, int count, int digit)
+{
+	const int NUM_DIGITS = (Order::KEY_BITS + 7) / 8;
+
+	for (; digit < NUM_DIGITS; digit++)
+	{
+		if (count <= RADIX_INSERTION_SORT_MAX)
+		{
+			insertionSortByKey<Order>(values, count);
+
+			return;
+		}
+
+		int counts[256];
+
+		if (!countDigits<Order>(values, count, digit, counts))
+			continue;
+
+		int next[256];
+
+		for (int bucket = 0, start = 0; bucket < 256; bucket++)
+		{
+			next[bucket] = start;
+
+			start += counts[bucket];
+		}
+
+		for (int i = 0; i < count; i++)
+			scratch[next[keyDigit<Order>(values[i], digit)]++] = values[i];
+
+		memcpy(values, scratch, count * sizeof(int));
+
+		for (int bucket = 0, start = 0; bucket < 256; start += counts[bucket], bucket++)
+		{
+			if (counts[bucket] > 1)
+				radixSortStable<Order>(values + start, scratch + start, counts[bucket], digit + 1);
+		}
+
+		return;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  countDigits
+//
+//        Purpose:  Counts how many ints have each value of one byte of their keys.
+//
+//      Parameter:  values is the array of ints.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//      Parameter:  digit is the index of the key byte to count, starting at 0 for the highest byte.
+//
+//      Parameter:  counts is set to the number of ints with each of the 256 byte values.
+//
+//        Returns:  True if the ints are split between more than one bucket.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+bool countDigits(const int* values, int count, int digit, int* counts)
+{
+	memset(counts, 0, 256 * sizeof(int));
+
+	for (int i = 0; i < count; i++)
+		counts[keyDigit<Order>(values[i], digit)]++;
+
+	return counts[keyDigit<Order>(values[0], digit)] != count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  insertionSortByKey
+//
+//        Purpose:  Sorts a small array of ints by their keys, keeping ints with equal keys in order.
+//
+//      Parameter:  values is the array of ints to sort.
+//
+//      Parameter:  count is the number of ints in the array.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void insertionSortByKey(int* values, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		int value = values[i];
+
+		unsigned long long key = Order::key(value);
+
+		int j = i;
+
+		for (; j > 0 && key < Order::key(values[j - 1]); j--)
+			values[j] = values[j - 1];
+
+		values[j] = value;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  keyDigit
+//
+//        Purpose:  Finds one byte of the normalized key of an int.
+//
+//      Parameter:  value is the int.
+//
+//      Parameter:  digit is the index of the byte, starting at 0 for the highest byte. If the key's
+//                  number of bits is not a multiple of 8, the last byte is padded with zeros.
+//
+//        Returns:  The byte of the key.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+unsigned int keyDigit(int value, int digit)
+{
+	unsigned long long key = Order::key(value) << (64 - Order::KEY_BITS);
+
+	return (unsigned int)(key >> (56 - digit * 8)) & 0xFF;
+}
+
+#endif
\ No newline at end of file
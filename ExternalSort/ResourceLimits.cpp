@@ -0,0 +1,438 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    ResourceLimits.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains functions for detecting the memory and CPU limits of the control
+//                    group the process runs in, and for keeping the memory budget and thread counts of
+//                    the sort within them.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "ResourceLimits.h"
+
+// Memory limits this large mean there is no limit. cgroup v1 reports no limit as the largest 64-bit
+// number that is a multiple of the page size, rather than as "max" like cgroup v2.
+static const long long NO_MEMORY_LIMIT = 1LL << 60;
+
+static bool hasController(const std::string&, const char*);
+static std::string cgroupDirectory(const std::string&, const std::string&);
+static void readLimitsUpTo(const std::string&, std::string, bool, ResourceLimits&);
+static long long readNumber(const std::string&);
+static long long readStatNumber(const std::string&, const char*);
+static double readCpuLimit(const std::string&, const std::string&);
+static void readMemoryUsage(const std::string&, const char*, const char*, ResourceLimits&);
+static void lowerMemoryLimit(ResourceLimits&, long long);
+static void lowerCpuLimit(ResourceLimits&, double);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  detectResourceLimits
+//
+//        Purpose:  Finds the memory and CPU limits of the process from the control groups listed in
+//                  /proc/self/cgroup. Limits set on a cgroup apply to every cgroup below it, so the
+//                  lowest limit of the process's cgroup and its ancestors is the one that counts. The
+//                  cgroup v2 hierarchy is used if it has the memory or CPU controller, and the v1
+//                  memory and cpu hierarchies for any limit it does not have. memory.high is treated
+//                  as a limit along with memory.max, because a cgroup over it has its memory reclaimed
+//                  and is slowed down.
+//
+//        Returns:  The limits, which are all unset on systems other than Linux.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+ResourceLimits detectResourceLimits()
+{
+	ResourceLimits limits;
+
+	limits.memoryLimit = -1;
+
+	limits.memoryUsage = 0;
+
+	limits.cpuLimit = 0;
+
+#ifdef __linux__
+	std::ifstream cgroupFile("/proc/self/cgroup");
+
+	std::string line, v2Path, memoryPath, cpuPath;
+
+	// Each line is a hierarchy ID, the controllers of the hierarchy, and the path of the process's
+	// cgroup in it, separated by colons. The cgroup v2 line has ID 0 and no controllers.
+	while (std::getline(cgroupFile, line))
+	{
+		size_t firstColon = line.find(':');
+
+		size_t secondColon = line.find(':', firstColon + 1);
+
+		if (firstColon == std::string::npos || secondColon == std::string::npos)
+			continue;
+
+		std::string controllers = line.substr(firstColon + 1, secondColon - firstColon - 1);
+
+		std::string path = line.substr(secondColon + 1);
+
+		if (line.compare(0, firstColon, "0") == 0 && controllers.empty())
+			v2Path = path;
+		else if (hasController(controllers, "memory"))
+			memoryPath = path;
+		else if (hasController(controllers, "cpu"))
+			cpuPath = path;
+	}
+
+	// The v2 hierarchy is mounted at /sys/fs/cgroup on its own, or at /sys/fs/cgroup/unified alongside
+	// the v1 hierarchies, where it usually has no controllers
+	if (!v2Path.empty())
+	{
+		const char* v2Roots[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+
+		for (int i = 0; i < 2 && limits.cgroupDirectory.empty(); i++)
+		{
+			std::ifstream controllersFile(std::string(v2Roots[i]) + "/cgroup.controllers");
+
+			std::string controller;
+
+			while (controllersFile >> controller)
+			{
+				if (controller == "memory" || controller == "cpu")
+					limits.cgroupDirectory = cgroupDirectory(v2Roots[i], v2Path);
+			}
+
+			if (!limits.cgroupDirectory.empty())
+			{
+				readLimitsUpTo(v2Roots[i], limits.cgroupDirectory, true, limits);
+
+				readMemoryUsage(limits.cgroupDirectory, "memory.current", "file", limits);
+			}
+		}
+	}
+
+	// A system with both hierarchies may keep either controller in v1
+	if (limits.memoryLimit < 0 && !memoryPath.empty())
+	{
+		std::string directory = cgroupDirectory("/sys/fs/cgroup/memory", memoryPath);
+
+		readLimitsUpTo("/sys/fs/cgroup/memory", directory, false, limits);
+
+		readMemoryUsage(directory, "memory.usage_in_bytes", "total_cache", limits);
+	}
+
+	if (limits.cpuLimit <= 0 && !cpuPath.empty())
+		readLimitsUpTo("/sys/fs/cgroup/cpu", cgroupDirectory("/sys/fs/cgroup/cpu", cpuPath), false, limits);
+#endif
+
+	return limits;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  applyResourceLimits
+//
+//        Purpose:  Lowers the maximum number of ints allowed in memory simultaneously if the memory left
+//                  under the process's memory limit cannot hold them, and prints a note saying so. The
+//                  ints are only given half of the memory left, since a stable radix sort needs a
+//                  scratch copy of the ints it sorts, and the program needs some memory of its own.
+//
+//      Parameter:  options holds the maximum number of ints allowed in memory, which may be lowered.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void applyResourceLimits(SortOptions& options)
+{
+	ResourceLimits limits = detectResourceLimits();
+
+	if (limits.memoryLimit < 0)
+		return;
+
+	long long maxInts = (limits.memoryLimit - limits.memoryUsage) / 2 / (long long)sizeof(int);
+
+	if (maxInts < 2)
+		maxInts = 2;
+
+	if (options.maxFileInts <= maxInts)
+		return;
+
+	std::cout << "Keeping at most " << maxInts << " ints in memory to stay under the memory limit of "
+		<< limits.memoryLimit << " bytes." << std::endl;
+
+	options.maxFileInts = (int)maxInts;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  availableCpus
+//
+//        Purpose:  Finds how many threads can run at once without being throttled, which is the number
+//                  of hardware threads, lowered to the process's CPU limit rounded up.
+//
+//        Returns:  The number of CPUs available, which is at least 1.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int availableCpus()
+{
+	int numCpus = (int)std::thread::hardware_concurrency();
+
+	if (numCpus < 1)
+		numCpus = 1;
+
+	double cpuLimit = detectResourceLimits().cpuLimit;
+
+	if (cpuLimit > 0 && std::ceil(cpuLimit) < numCpus)
+		numCpus = (int)std::ceil(cpuLimit);
+
+	return numCpus;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  hasController
+//
+//        Purpose:  Checks whether a comma-separated list of cgroup controllers, such as "cpu,cpuacct",
+//                  holds a controller.
+//
+//      Parameter:  controllers is the list of controllers.
+//
+//      Parameter:  controller is the controller to look for.
+//
+//        Returns:  True if the list holds the controller.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool hasController(const std::string& controllers, const char* controller)
+{
+	return ("," + controllers + ",").find("," + std::string(controller) + ",") != std::string::npos;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  cgroupDirectory
+//
+//        Purpose:  Builds the directory of a cgroup in a mounted cgroup hierarchy. Inside a container the
+//                  hierarchy is often mounted at the container's own cgroup, so the path listed in
+//                  /proc/self/cgroup does not exist under it, and the root of the mount is used instead.
+//
+//      Parameter:  root is the directory the hierarchy is mounted at.
+//
+//      Parameter:  path is the path of the cgroup in the hierarchy.
+//
+//        Returns:  The directory of the cgroup.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string cgroupDirectory(const std::string& root, const std::string& path)
+{
+	if (path.empty() || path == "/")
+		return root;
+
+	std::ifstream procsFile(root + path + "/cgroup.procs");
+
+	return procsFile.is_open() ? root + path : root;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readLimitsUpTo
+//
+//        Purpose:  Reads the memory and CPU limits of a cgroup and of each of its ancestors up to the
+//                  root of its hierarchy, lowering the limits found so far to them.
+//
+//      Parameter:  root is the directory the hierarchy is mounted at.
+//
+//      Parameter:  directory is the directory of the cgroup.
+//
+//      Parameter:  v2 is true if the hierarchy is cgroup v2, or false if it is cgroup v1.
+//
+//      Parameter:  limits holds the limits found so far, and receives any lower ones.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void readLimitsUpTo(const std::string& root, std::string directory, bool v2, ResourceLimits& limits)
+{
+	while (true)
+	{
+		if (v2)
+		{
+			lowerMemoryLimit(limits, readNumber(directory + "/memory.max"));
+
+			lowerMemoryLimit(limits, readNumber(directory + "/memory.high"));
+
+			lowerCpuLimit(limits, readCpuLimit(directory + "/cpu.max", ""));
+		}
+		else
+		{
+			lowerMemoryLimit(limits, readNumber(directory + "/memory.limit_in_bytes"));
+
+			lowerCpuLimit(limits, readCpuLimit(directory + "/cpu.cfs_quota_us", directory + "/cpu.cfs_period_us"));
+		}
+
+		if (directory.size() <= root.size())
+			break;
+
+		directory = directory.substr(0, directory.rfind('/'));
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readNumber
+//
+//        Purpose:  Reads the number a cgroup file starts with.
+//
+//      Parameter:  path is the path of the file.
+//
+//        Returns:  The number, or -1 if the file does not exist, holds "max", or holds a negative number.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static long long readNumber(const std::string& path)
+{
+	std::ifstream file(path);
+
+	std::string word;
+
+	if (!(file >> word) || word == "max")
+		return -1;
+
+	long long number = strtoll(word.c_str(), nullptr, 10);
+
+	return (number >= 0) ? number : -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readStatNumber
+//
+//        Purpose:  Reads one value of a cgroup's memory.stat file, which holds a name and a number on each
+//                  line.
+//
+//      Parameter:  path is the path of the memory.stat file.
+//
+//      Parameter:  name is the name of the value.
+//
+//        Returns:  The value, or 0 if the file does not have it.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static long long readStatNumber(const std::string& path, const char* name)
+{
+	std::ifstream file(path);
+
+	std::string statName;
+
+	long long value;
+
+	while (file >> statName >> value)
+	{
+		if (statName == name)
+			return value;
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readCpuLimit
+//
+//        Purpose:  Reads a cgroup's CPU quota and the period it is given over. cgroup v2 keeps both in
+//                  cpu.max, and cgroup v1 keeps them in separate files.
+//
+//      Parameter:  quotaPath is the path of the file holding the quota.
+//
+//      Parameter:  periodPath is the path of the file holding the period, or an empty string if the
+//                  period follows the quota in the same file.
+//
+//        Returns:  The quota divided by the period, which is the number of CPUs' worth of time the
+//                  cgroup may use, or 0 if it has no quota.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static double readCpuLimit(const std::string& quotaPath, const std::string& periodPath)
+{
+	std::ifstream quotaFile(quotaPath);
+
+	std::string quota;
+
+	double period = 0;
+
+	if (!(quotaFile >> quota) || quota == "max")
+		return 0;
+
+	if (periodPath.empty())
+		quotaFile >> period;
+	else
+	{
+		std::ifstream periodFile(periodPath);
+
+		periodFile >> period;
+	}
+
+	double quotaMicroseconds = atof(quota.c_str());
+
+	return (quotaMicroseconds > 0 && period > 0) ? quotaMicroseconds / period : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readMemoryUsage
+//
+//        Purpose:  Reads how much memory a cgroup is using that cannot simply be dropped. Cached pages of
+//                  files are counted in the cgroup's usage, but are reclaimed before the cgroup runs out
+//                  of memory, so they are left out.
+//
+//      Parameter:  directory is the directory of the cgroup.
+//
+//      Parameter:  usageFile is the name of the file holding the cgroup's usage.
+//
+//      Parameter:  cacheStat is the name of the memory.stat value holding the bytes of cached files.
+//
+//      Parameter:  limits receives the usage.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void readMemoryUsage(const std::string& directory, const char* usageFile, const char* cacheStat, ResourceLimits& limits)
+{
+	long long usage = readNumber(directory + "/" + usageFile) - readStatNumber(directory + "/memory.stat", cacheStat);
+
+	limits.memoryUsage = (usage > 0) ? usage : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  lowerMemoryLimit
+//
+//        Purpose:  Lowers the memory limit found so far to another limit, if it is lower.
+//
+//      Parameter:  limits holds the memory limit found so far.
+//
+//      Parameter:  bytes is the other limit, or -1 if there is none.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void lowerMemoryLimit(ResourceLimits& limits, long long bytes)
+{
+	if (bytes < 0 || bytes >= NO_MEMORY_LIMIT)
+		return;
+
+	if (limits.memoryLimit < 0 || bytes < limits.memoryLimit)
+		limits.memoryLimit = bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  lowerCpuLimit
+//
+//        Purpose:  Lowers the CPU limit found so far to another limit, if it is lower.
+//
+//      Parameter:  limits holds the CPU limit found so far.
+//
+//      Parameter:  cpus is the other limit, or 0 if there is none.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void lowerCpuLimit(ResourceLimits& limits, double cpus)
+{
+	if (cpus <= 0)
+		return;
+
+	if (limits.cpuLimit <= 0 || cpus < limits.cpuLimit)
+		limits.cpuLimit = cpus;
+}
\ No newline at end of file
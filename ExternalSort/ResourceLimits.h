@@ -0,0 +1,48 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  ResourceLimits.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the ResourceLimits struct declaration, which holds the memory and
+//                  CPU limits of the control group the process runs in, along with the functions that
+//                  detect them and keep the sort within them. A sort in a container whose memory budget
+//                  is larger than the container's memory limit would otherwise be killed once it fills
+//                  its buffers. The limits are read from cgroup v2, or from cgroup v1 if the system has
+//                  no v2 memory or CPU controller, and only on Linux. Elsewhere there are no limits.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RESOURCELIMITS_H
+#define RESOURCELIMITS_H
+
+#include <string>
+
+#include "SortOptions.h"
+
+// The memory and CPU limits of the process
+struct ResourceLimits
+{
+	// The most bytes of memory the process may use before it is reclaimed from or killed, or -1 if
+	// there is no limit. This is the lowest memory.max or memory.high of the cgroup and its ancestors.
+	long long memoryLimit;
+
+	// The bytes of memory the cgroup was already using when the limits were detected, which are not
+	// available to the sort
+	long long memoryUsage;
+
+	// The number of CPUs' worth of time the process may use, or 0 if there is no limit. This is the
+	// lowest cpu.max quota divided by its period of the cgroup and its ancestors.
+	double cpuLimit;
+
+	// The directory of the cgroup in the cgroup v2 file system, or an empty string if it was not found
+	std::string cgroupDirectory;
+};
+
+ResourceLimits detectResourceLimits();
+void applyResourceLimits(SortOptions&);
+int availableCpus();
+
+#endif
\ No newline at end of file
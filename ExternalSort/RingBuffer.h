@@ -0,0 +1,199 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  RingBuffer.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the MpscRing class template, a fixed-size lock-free queue used to
+//                  pass requests from the stages of the sort to the I/O thread. Any number of threads can
+//                  push, with one thread popping. The positions that the two sides update are kept on
+//                  separate cache lines so the threads do not slow each other down, and items can be
+//                  pushed and popped in batches to cut down on the number of shared updates.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// The size of a cache line on the processors the sort runs on
+const int CACHE_LINE_SIZE = 64;
+
+// Waits a little before a thread tries again to push onto a full ring or pop from an empty one. The first
+// few waits only yield the processor, so a quick reply is picked up right away. After that, the thread
+// sleeps so that it does not use up a processor while the other side of the ring is busy with I/O.
+inline void waitForRing(int& numWaits)
+{
+	const int NUM_YIELDS = 64;
+
+	if (numWaits < NUM_YIELDS)
+		std::this_thread::yield();
+	else
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+	numWaits++;
+}
+
+// Rounds a capacity up to a power of two, so that a position is turned into a slot index by masking off
+// its high bits
+inline unsigned ringCapacity(int minCapacity)
+{
+	unsigned capacity = 1;
+
+	while (capacity < (unsigned)minCapacity)
+		capacity *= 2;
+
+	return capacity;
+}
+
+template <typename T>
+class MpscRing
+{
+public:
+	explicit MpscRing(int minCapacity)
+		: slots(ringCapacity(minCapacity)), mask((unsigned)slots.size() - 1), head(0), tail(0)
+	{
+		// A slot is free for the item at a position when its sequence number equals the position, and
+		// holds that item when its sequence number is one past the position
+		for (unsigned i = 0; i < slots.size(); i++)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	int capacity() const
+	{
+		return (int)slots.size();
+	}
+
+	// Adds an item to the back of the ring. May be called by any thread. Returns false if the ring is full.
+	bool tryPush(const T& item)
+	{
+		return tryPushBatch(&item, 1) == 1;
+	}
+
+	// Removes the item at the front of the ring. Must only be called by the popping thread. Returns false
+	// if the ring is empty.
+	bool tryPop(T& item)
+	{
+		return tryPopBatch(&item, 1) == 1;
+	}
+
+	// Adds all numItems items to the back of the ring next to each other. May be called by any thread.
+	// Returns numItems, or 0 if the ring does not have room for all of them.
+	int tryPushBatch(const T* items, int numItems)
+	{
+		if (numItems <= 0 || (unsigned)numItems > slots.size())
+			return 0;
+
+		unsigned position = tail.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			// Items are popped in order, so if the last slot needed is free, all the slots before it are
+			unsigned last = position + numItems - 1;
+
+			int lag = (int)(slots[last & mask].sequence.load(std::memory_order_acquire) - last);
+
+			if (lag < 0)
+				return 0;
+
+			// Claim the slots, unless another thread pushed first, in which case try again after it
+			if (lag == 0 && tail.compare_exchange_weak(position, position + numItems, std::memory_order_relaxed))
+				break;
+
+			if (lag > 0)
+				position = tail.load(std::memory_order_relaxed);
+		}
+
+		for (int i = 0; i < numItems; i++)
+		{
+			Slot& slot = slots[(position + i) & mask];
+
+			slot.item = items[i];
+
+			slot.sequence.store(position + i + 1, std::memory_order_release);
+		}
+
+		return numItems;
+	}
+
+	// Removes up to maxItems items from the front of the ring, and returns how many were removed
+	int tryPopBatch(T* items, int maxItems)
+	{
+		unsigned position = head.load(std::memory_order_relaxed);
+
+		int numPopped = 0;
+
+		while (numPopped < maxItems)
+		{
+			Slot& slot = slots[(position + numPopped) & mask];
+
+			if (slot.sequence.load(std::memory_order_acquire) != position + numPopped + 1)
+				break;
+
+			items[numPopped] = slot.item;
+
+			// Free the slot for the item one lap later
+			slot.sequence.store(position + numPopped + (unsigned)slots.size(), std::memory_order_release);
+
+			numPopped++;
+		}
+
+		head.store(position + numPopped, std::memory_order_relaxed);
+
+		return numPopped;
+	}
+
+	// Adds an item to the back of the ring, waiting for room if it is full
+	void push(const T& item)
+	{
+		int numWaits = 0;
+
+		while (!tryPush(item))
+			waitForRing(numWaits);
+	}
+
+	// Removes the item at the front of the ring, waiting for one if it is empty
+	T pop()
+	{
+		T item;
+
+		int numWaits = 0;
+
+		while (!tryPop(item))
+			waitForRing(numWaits);
+
+		return item;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<unsigned> sequence;
+
+		T item;
+	};
+
+	std::vector<Slot> slots;
+
+	unsigned mask;
+
+	char slotsPadding[CACHE_LINE_SIZE];
+
+	// The position of the next item to pop, which only the popping thread uses
+	std::atomic<unsigned> head;
+
+	char headPadding[CACHE_LINE_SIZE];
+
+	// The position of the next slot to claim for pushing
+	std::atomic<unsigned> tail;
+
+	char tailPadding[CACHE_LINE_SIZE];
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  SetOperations.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the set operations, which combine any number of streams of ints
+//                  sorted in the same order. Each stream is treated as a set, so ints that are equal in
+//                  the order are written only once, and the result is sorted. The union merges the
+//                  streams with a loser tree. The intersection and difference seek through the streams
+//                  with galloping cursors, so when one set is much smaller than the others, the larger
+//                  ones are skipped through a stretch at a time instead of being compared int by int.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SETOPERATIONS_H
+#define SETOPERATIONS_H
+
+#include <vector>
+
+#include "LoserTree.h"
+#include "OutputWriter.h"
+#include "StreamCursor.h"
+
+// The set operations
+enum SetOperation
+{
+	// Writes every int that is in any of the streams
+	SET_UNION,
+
+	// Writes every int that is in all of the streams
+	SET_INTERSECTION,
+
+	// Writes every int of the first stream that is in none of the others
+	SET_DIFFERENCE
+};
+
+template <class Stream, class Order> void setUnion(std::vector<StreamCursor<Stream>*>&, OutputWriter&, const Order&);
+template <class Stream, class Order> void setIntersection(std::vector<StreamCursor<Stream>*>&, OutputWriter&, const Order&);
+template <class Stream, class Order> void setDifference(std::vector<StreamCursor<Stream>*>&, OutputWriter&, const Order&);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  applySetOperation
+//
+//        Purpose:  Combines sorted streams with a set operation, and writes the result.
+//
+//      Parameter:  streams holds the streams, of which there must be at least one. For a difference, the
+//                  first stream is the one the others are subtracted from.
+//
+//      Parameter:  operation is the set operation.
+//
+//      Parameter:  output is the writer of the result.
+//
+//      Parameter:  order is the order all of the streams are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream, class Order>
+void applySetOperation(std::vector<Stream*>& streams, SetOperation operation, OutputWriter& output, const Order& order)
+{
+	std::vector<StreamCursor<Stream>*> cursors;
+
+	for (int i = 0; i < (int)streams.size(); i++)
+		cursors.push_back(new StreamCursor<Stream>(*streams[i]));
+
+	if (operation == SET_UNION)
+		setUnion(cursors, output, order);
+	else if (operation == SET_INTERSECTION)
+		setIntersection(cursors, output, order);
+	else
+		setDifference(cursors, output, order);
+
+	for (int i = 0; i < (int)cursors.size(); i++)
+		delete cursors[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  setUnion
+//
+//        Purpose:  Merges the streams with a loser tree, writing each int that comes after the last int
+//                  written. Of a group of equal ints, the first one from the earliest stream is written.
+//
+//      Parameter:  cursors holds a cursor on each stream.
+//
+//      Parameter:  output is the writer of the result.
+//
+//      Parameter:  order is the order all of the streams are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream, class Order>
+void setUnion(std::vector<StreamCursor<Stream>*>& cursors, OutputWriter& output, const Order& order)
+{
+	// The tree only plays the streams that have ints
+	std::vector<StreamCursor<Stream>*> nonEmpty;
+
+	std::vector<int> firstValues;
+
+	for (int i = 0; i < (int)cursors.size(); i++)
+	{
+		if (cursors[i]->atEnd())
+			continue;
+
+		nonEmpty.push_back(cursors[i]);
+
+		firstValues.push_back(cursors[i]->value());
+	}
+
+	LoserTree<Order> tree(firstValues.data(), (int)nonEmpty.size(), order);
+
+	bool wroteAny = false;
+
+	int lastWritten = 0;
+
+	while (!tree.empty())
+	{
+		StreamCursor<Stream>* winner = nonEmpty[tree.winner()];
+
+		int value = winner->value();
+
+		if (!wroteAny || order(lastWritten, value))
+		{
+			output.write(&value, 1);
+
+			lastWritten = value;
+
+			wroteAny = true;
+		}
+
+		winner->advance();
+
+		if (winner->atEnd())
+			tree.exhaustWinner();
+		else
+			tree.replaceWinner(winner->value());
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  setIntersection
+//
+//        Purpose:  Intersects the streams by leapfrogging. The candidate is the largest int the cursors
+//                  have stopped at so far, and each cursor in turn seeks to it. A cursor that stops past
+//                  the candidate makes its int the new candidate. Once every cursor has stopped at an
+//                  int equal to the candidate, the candidate is written and the first cursor moves past
+//                  it. The cost depends mostly on the smallest stream, since every seek gallops.
+//
+//      Parameter:  cursors holds a cursor on each stream.
+//
+//      Parameter:  output is the writer of the result.
+//
+//      Parameter:  order is the order all of the streams are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream, class Order>
+void setIntersection(std::vector<StreamCursor<Stream>*>& cursors, OutputWriter& output, const Order& order)
+{
+	int numCursors = (int)cursors.size();
+
+	for (int i = 0; i < numCursors; i++)
+	{
+		if (cursors[i]->atEnd())
+			return;
+	}
+
+	int candidate = cursors[0]->value();
+
+	// The number of cursors in a row that have stopped at an int equal to the candidate
+	int numMatched = 1;
+
+	int current = 0;
+
+	while (true)
+	{
+		if (numMatched == numCursors)
+		{
+			output.write(&candidate, 1);
+
+			cursors[0]->seek(candidate, true, order);
+
+			if (cursors[0]->atEnd())
+				return;
+
+			candidate = cursors[0]->value();
+
+			numMatched = 1;
+
+			current = 0;
+
+			continue;
+		}
+
+		current = (current + 1) % numCursors;
+
+		cursors[current]->seek(candidate, false, order);
+
+		if (cursors[current]->atEnd())
+			return;
+
+		if (order(candidate, cursors[current]->value()))
+		{
+			candidate = cursors[current]->value();
+
+			numMatched = 1;
+		}
+		else
+			numMatched++;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  setDifference
+//
+//        Purpose:  Writes each distinct int of the first stream that none of the other streams has. The
+//                  other streams seek to each int of the first, so their ints between two ints of the
+//                  first stream are galloped over.
+//
+//      Parameter:  cursors holds a cursor on each stream.
+//
+//      Parameter:  output is the writer of the result.
+//
+//      Parameter:  order is the order all of the streams are sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream, class Order>
+void setDifference(std::vector<StreamCursor<Stream>*>& cursors, OutputWriter& output, const Order& order)
+{
+	StreamCursor<Stream>* first = cursors[0];
+
+	while (!first->atEnd())
+	{
+		int value = first->value();
+
+		bool found = false;
+
+		for (int i = 1; i < (int)cursors.size() && !found; i++)
+		{
+			cursors[i]->seek(value, false, order);
+
+			found = !cursors[i]->atEnd() && !order(value, cursors[i]->value());
+		}
+
+		if (!found)
+			output.write(&value, 1);
+
+		first->seek(value, true, order);
+	}
+}
+
+#endif
@@ -0,0 +1,32 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  SortChunk.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the SortChunk struct declaration, which represents a chunk of ints
+//                  from the unsorted file as it is read, sorted, and written to a temp file.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SORTCHUNK_H
+#define SORTCHUNK_H
+
+#include "AsyncIo.h"
+
+// Represents a chunk of ints from the unsorted file
+struct SortChunk
+{
+	// The ints in the chunk
+	int* values;
+
+	// The number of ints in the chunk
+	int count;
+
+	// The last read or write of the chunk that was submitted
+	IoRequest request;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  SortOptions.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the SortOptions struct declaration, which holds the settings that
+//                  control how a file is sorted: how much memory may be used, where the temp files are
+//                  written, and how the temp files are merged.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SORTOPTIONS_H
+#define SORTOPTIONS_H
+
+#include <string>
+
+#include "Cancellation.h"
+#include "Progress.h"
+
+// Settings that control how a file is sorted
+struct SortOptions
+{
+	// The maximum number of integers from the file that are allowed in memory simultaneously
+	int maxFileInts;
+
+	// The directory that temp files are written to, or an empty string for the current directory
+	std::string tempDirectory;
+
+	// Text put in front of the number of each temp file's name, so that the temp files of several sorts
+	// running at once do not collide
+	std::string tempPrefix;
+
+	// The maximum number of files that are merged at one time
+	int fanIn;
+
+	// The number of ints buffered from each file while it is being merged
+	int bufferInts;
+
+	// The number of extra buffers, each holding bufferInts ints, that blocks of the files being merged
+	// are read into ahead of time
+	int prefetchBuffers;
+
+	// The number of buffers, each holding bufferInts ints, that the merged output is written through
+	int outputBuffers;
+
+	// Whether ints that compare equal must keep the order they had in the unsorted file
+	bool stable;
+
+	// Whether the merge trees use offset-value coding to avoid comparing full keys. Only orders with
+	// normalized keys can use it.
+	bool offsetValueCoding;
+
+	// The number of ints between two entries of the index written next to the sorted file, or 0 if no
+	// index is written
+	int indexInterval;
+
+	// Whether the ints are hashed as the input is read and as the output is written, so the sort can
+	// check that its output holds the same ints as its input
+	bool selfCheck;
+
+	// The number of requests to use less memory that the memory budget and merge shape have already
+	// been shrunk for
+	int memoryReliefs;
+
+	// The tracker told how far the sort has gotten, or a null pointer if no one is following it
+	ProgressTracker* progress;
+
+	// The token that stops the sort once it is cancelled, or a null pointer if it cannot be cancelled
+	CancelToken* cancel;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  SortOrder.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the order policies that the sort can be instantiated with. An order
+//                  policy is any copyable function object whose operator()(int a, int b) returns true if
+//                  a comes before b. The policy is a template parameter of the sort, the loser tree, and
+//                  the prefetcher, so its comparisons are inlined into the run sort and the merge just like
+//                  the built-in less than is. Ints for which neither comes before the other are equal,
+//                  and are kept in the order of the unsorted file by a stable sort.
+//
+//                  The policies here also give every int a normalized key of KEY_BITS bits, an unsigned
+//                  number that orders the ints the same way the policy does. A key compares the same way
+//                  as a number as it does byte by byte with memcmp once it is written out with
+//                  encodeKey, so sorting by keys needs only one comparison however many columns the
+//                  order has, and the keys can be radix sorted.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SORTORDER_H
+#define SORTORDER_H
+
+// Sorts ints from smallest to largest
+struct Ascending
+{
+	static const bool DESCENDING = false;
+
+	static const int KEY_BITS = 32;
+
+	bool operator()(int a, int b) const
+	{
+		return a < b;
+	}
+
+	// Flipping the sign bit orders negative ints before positive ones as unsigned numbers
+	static unsigned long long key(int value)
+	{
+		return (unsigned int)value ^ 0x80000000u;
+	}
+};
+
+// Sorts ints from largest to smallest
+struct Descending
+{
+	static const bool DESCENDING = true;
+
+	static const int KEY_BITS = 32;
+
+	bool operator()(int a, int b) const
+	{
+		return a > b;
+	}
+
+	static unsigned long long key(int value)
+	{
+		return ~((unsigned int)value ^ 0x80000000u);
+	}
+};
+
+// Sorts ints holding the bits of IEEE floats by the floats, smallest to largest, or largest to smallest
+// if Direction is Descending. Negative zero comes before positive zero, and NaNs come after infinity
+// if they are positive or before negative infinity if they are negative.
+template <class Direction = Ascending>
+struct AsFloat
+{
+	static const int KEY_BITS = 32;
+
+	bool operator()(int a, int b) const
+	{
+		return key(a) < key(b);
+	}
+
+	// Negative floats have their bits flipped, so the larger their magnitude the smaller their key,
+	// and positive floats have their sign bit flipped so they come after all negative floats
+	static unsigned long long key(int value)
+	{
+		unsigned int bits = (unsigned int)value;
+
+		unsigned int ascending = (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+
+		return Direction::DESCENDING ? ~ascending : ascending;
+	}
+};
+
+// Sorts ints by a field of NUM_BITS bits, fewer than 32, starting SHIFT bits from the lowest bit and
+// treated as an unsigned number, in the order given by Direction. This lets ints that pack several
+// columns into their bits be sorted by one column.
+template <int SHIFT, int NUM_BITS, class Direction = Ascending>
+struct Column
+{
+	static const int KEY_BITS = NUM_BITS;
+
+	bool operator()(int a, int b) const
+	{
+		return direction(field(a), field(b));
+	}
+
+	static int field(int value)
+	{
+		return (int)(((unsigned int)value >> SHIFT) & ((1ULL << NUM_BITS) - 1));
+	}
+
+	static unsigned long long key(int value)
+	{
+		unsigned long long ascending = field(value);
+
+		return Direction::DESCENDING ? ((1ULL << NUM_BITS) - 1) - ascending : ascending;
+	}
+
+	Direction direction;
+};
+
+// Sorts ints by First, and ints that are equal by First by Then. Orders can be chained to sort by any
+// number of columns, such as ThenBy<Column<16, 16>, ThenBy<Column<8, 8, Descending>, Column<0, 8>>>.
+// The normalized key is First's key followed by Then's key, so the two may have at most 64 key bits.
+template <class First, class Then>
+struct ThenBy
+{
+	static const int KEY_BITS = First::KEY_BITS + Then::KEY_BITS;
+
+	bool operator()(int a, int b) const
+	{
+		if (first(a, b))
+			return true;
+
+		if (first(b, a))
+			return false;
+
+		return then(a, b);
+	}
+
+	static unsigned long long key(int value)
+	{
+		static_assert(KEY_BITS <= 64, "A normalized key can have at most 64 bits.");
+
+		return (First::key(value) << Then::KEY_BITS) | Then::key(value);
+	}
+
+	First first;
+
+	Then then;
+};
+
+// Sorts ints in the same order as Order, but by comparing their normalized keys. For orders with
+// several columns, this takes one comparison instead of one or two per column.
+template <class Order>
+struct ByKey
+{
+	static const int KEY_BITS = Order::KEY_BITS;
+
+	bool operator()(int a, int b) const
+	{
+		return Order::key(a) < Order::key(b);
+	}
+
+	static unsigned long long key(int value)
+	{
+		return Order::key(value);
+	}
+};
+
+// HasNormalizedKey<Order>::value is true if Order gives ints normalized keys, so they can be radix
+// sorted. Orders written without a key function are sorted by comparisons instead.
+template <class Order>
+struct HasNormalizedKey
+{
+	template <class T> static char test(decltype(&T::key));
+	template <class T> static long test(...);
+
+	static const bool value = sizeof(test<Order>(nullptr)) == sizeof(char);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  StreamCursor.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the StreamCursor class template, which reads the ints of a
+//                  MergeStream one at a time for the operators that consume sorted streams, such as the
+//                  merge-join and the set operations. A cursor can also seek forward to an int, galloping
+//                  through the stretches the stream hands out, so a small stream can be matched against a
+//                  much larger one without comparing against every int of the larger one.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STREAMCURSOR_H
+#define STREAMCURSOR_H
+
+template <class Stream>
+class StreamCursor
+{
+public:
+	StreamCursor(Stream& stream)
+		: source(stream), position(0)
+	{
+		count = source.next(values);
+	}
+
+	// Whether every int of the stream has been read
+	bool atEnd() const
+	{
+		return count == 0;
+	}
+
+	// The current int. The cursor must not be at the end.
+	int value() const
+	{
+		return values[position];
+	}
+
+	// Moves to the next int
+	void advance()
+	{
+		if (++position == count)
+		{
+			count = source.next(values);
+
+			position = 0;
+		}
+	}
+
+	template <class Order> void seek(int, bool, const Order&);
+
+private:
+	template <class Order> bool skips(int, int, bool, const Order&) const;
+
+	// The stream being read
+	Stream& source;
+
+	// The stretch of ints last handed out by the stream
+	const int* values;
+
+	// The number of ints in the stretch, or 0 once the stream has ended
+	int count;
+
+	// The index of the current int in the stretch
+	int position;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  seek
+//
+//        Purpose:  Moves forward to the first int that does not come before the target, or if pastEqual
+//                  is set, to the first int that the target comes before. A stretch whose last int is
+//                  skipped is passed over whole. Otherwise, the stretch is galloped through by checking
+//                  the ints at exponentially growing distances from the current one, and the exact int is
+//                  then found with a binary search.
+//
+//      Parameter:  target is the int to seek to.
+//
+//      Parameter:  pastEqual is true if ints equal to the target are skipped as well.
+//
+//      Parameter:  order is the order the stream is sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream>
+template <class Order>
+void StreamCursor<Stream>::seek(int target, bool pastEqual, const Order& order)
+{
+	while (count != 0 && skips(values[count - 1], target, pastEqual, order))
+	{
+		count = source.next(values);
+
+		position = 0;
+	}
+
+	if (count == 0 || !skips(values[position], target, pastEqual, order))
+		return;
+
+	// After this, values[lastSkipped] is known to be skipped and values[firstKept] is known to be kept
+	int lastSkipped = position;
+
+	int step = 1;
+
+	while (lastSkipped + step < count - 1 && skips(values[lastSkipped + step], target, pastEqual, order))
+	{
+		lastSkipped += step;
+
+		step *= 2;
+	}
+
+	int firstKept = (lastSkipped + step < count - 1) ? lastSkipped + step : count - 1;
+
+	while (firstKept - lastSkipped > 1)
+	{
+		int middle = lastSkipped + (firstKept - lastSkipped) / 2;
+
+		if (skips(values[middle], target, pastEqual, order))
+			lastSkipped = middle;
+		else
+			firstKept = middle;
+	}
+
+	position = firstKept;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  skips
+//
+//        Purpose:  Decides whether an int is passed over when seeking to a target.
+//
+//      Parameter:  value is the int.
+//
+//      Parameter:  target is the int being sought.
+//
+//      Parameter:  pastEqual is true if ints equal to the target are passed over as well.
+//
+//      Parameter:  order is the order the stream is sorted in.
+//
+//        Returns:  True if the int comes before the target, or is equal to it and pastEqual is set.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Stream>
+template <class Order>
+bool StreamCursor<Stream>::skips(int value, int target, bool pastEqual, const Order& order) const
+{
+	return pastEqual ? !order(target, value) : order(value, target);
+}
+
+#endif
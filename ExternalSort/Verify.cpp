@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort
+//
+//      File Name:    Verify.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the functions of the verifier that do not depend on the order the
+//                    file is sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceLimits.h"
+#include "Verify.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  mixInt
+//
+//        Purpose:  Mixes the bits of an int into a 64-bit number that looks random, using the finalizer
+//                  of the SplitMix64 generator. Adding up the mixes of a multiset of ints gives a hash of
+//                  the multiset that does not depend on the order the ints are added in.
+//
+//      Parameter:  value is the int.
+//
+//        Returns:  The mix.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long long mixInt(int value)
+{
+	unsigned long long mix = (unsigned int)value + 0x9E3779B97F4A7C15ULL;
+
+	mix = (mix ^ (mix >> 30)) * 0xBF58476D1CE4E5B9ULL;
+
+	mix = (mix ^ (mix >> 27)) * 0x94D049BB133111EBULL;
+
+	return mix ^ (mix >> 31);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  hashInts
+//
+//        Purpose:  Adds up the mixes of a block of ints. The loop has no branches and each int is mixed
+//                  on its own, so the compiler can vectorize it.
+//
+//      Parameter:  values is the block of ints.
+//
+//      Parameter:  count is the number of ints in the block.
+//
+//        Returns:  The sum of the mixes.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long long hashInts(const int* values, int count)
+{
+	unsigned long long hash = 0;
+
+	for (int i = 0; i < count; i++)
+		hash += mixInt(values[i]);
+
+	return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  numVerifyThreads
+//
+//        Purpose:  Chooses how many threads verify a file.
+//
+//        Returns:  The number of CPUs the process can use without being throttled.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int numVerifyThreads()
+{
+	return availableCpus();
+}
@@ -0,0 +1,248 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort
+//
+//      File Name:  Verify.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the verifier, which checks that a file is sorted and computes a
+//                  hash of the multiset of its ints. The file is split into one chunk per CPU available,
+//                  and each thread reads its own chunk, so the check runs as fast as the disk allows.
+//                  Each chunk is checked for order within itself, and the last int of each chunk is
+//                  checked against the first int of the next. The hash is the sum of a mix of every int,
+//                  so it does not depend on the order of the ints. A sorted file with the same hash and
+//                  number of ints as its unsorted file holds the same ints, barring a collision. A file
+//                  that cannot be read in full is reported as an error rather than verified.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What verifying a file found
+struct VerifyResult
+{
+	// The number of ints in the file
+	long long numInts;
+
+	// The position of the first int that comes before the int preceding it, or -1 if the file is sorted
+	long long firstUnsorted;
+
+	// The hash of the multiset of the file's ints
+	unsigned long long hash;
+};
+
+// The part of a file verified by one thread
+struct VerifyChunk
+{
+	// The positions of the chunk's first int and of the int after its last
+	long long first;
+
+	long long end;
+
+	// The position of the first int of the chunk that comes before the int preceding it, or -1
+	long long firstUnsorted;
+
+	// The sum of the mixes of the chunk's ints
+	unsigned long long hash;
+
+	// The first and last ints of the chunk, if it has any
+	int firstValue;
+
+	int lastValue;
+
+	// True if the thread could not open the file or read all of the chunk's ints
+	bool readFailed;
+};
+
+unsigned long long mixInt(int);
+unsigned long long hashInts(const int*, int);
+int numVerifyThreads();
+template <class Order> VerifyResult verifyFile(const std::string&, int, bool, const Order&);
+template <class Order> void verifyChunk(const std::string*, VerifyChunk*, int, bool, const Order*);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  verifyFile
+//
+//        Purpose:  Verifies a file with one thread per chunk. Once the threads are done, the chunks are
+//                  checked against each other and their hashes are added up.
+//
+//      Parameter:  path is the path of the file. The program exits if it cannot be opened or read.
+//
+//      Parameter:  maxInts is the maximum number of ints to read into memory at once, split between the
+//                  threads.
+//
+//      Parameter:  checkOrder is false if only the hash is needed, such as for an unsorted file.
+//
+//      Parameter:  order is the order the file should be sorted in.
+//
+//        Returns:  The number of ints, the first int out of order, and the hash.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+VerifyResult verifyFile(const std::string& path, int maxInts, bool checkOrder, const Order& order)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		std::cout << "Error opening input file " << path << "." << std::endl;
+		exit(0);
+	}
+
+	file.seekg(0, std::ios::end);
+
+	VerifyResult result;
+
+	result.numInts = (long long)file.tellg() / sizeof(int);
+
+	file.close();
+
+	// Every thread gets a chunk of at least one int and a buffer of at least one int
+	int numThreads = numVerifyThreads();
+
+	if (numThreads > result.numInts)
+		numThreads = (result.numInts > 0) ? (int)result.numInts : 1;
+
+	int bufferInts = (maxInts / numThreads > 0) ? maxInts / numThreads : 1;
+
+	std::vector<VerifyChunk> chunks(numThreads);
+
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		chunks[i].first = result.numInts * i / numThreads;
+
+		chunks[i].end = result.numInts * (i + 1) / numThreads;
+
+		threads.push_back(std::thread(verifyChunk<Order>, &path, &chunks[i], bufferInts, checkOrder, &order));
+	}
+
+	for (int i = 0; i < numThreads; i++)
+		threads[i].join();
+
+	// The buffer of a chunk that could not be read holds ints that are not in the file, so neither its
+	// order nor its hash says anything about the file
+	for (int i = 0; i < numThreads; i++)
+	{
+		if (chunks[i].readFailed)
+		{
+			std::cout << "Error reading input file " << path << "." << std::endl;
+			exit(1);
+		}
+	}
+
+	result.firstUnsorted = -1;
+
+	result.hash = 0;
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		result.hash += chunks[i].hash;
+
+		if (result.firstUnsorted >= 0 || !checkOrder || chunks[i].first == chunks[i].end)
+			continue;
+
+		if (i > 0 && order(chunks[i].firstValue, chunks[i - 1].lastValue))
+			result.firstUnsorted = chunks[i].first;
+		else
+			result.firstUnsorted = chunks[i].firstUnsorted;
+	}
+
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  verifyChunk
+//
+//        Purpose:  Reads one chunk of a file, checking its order and adding up its hash. This is run by
+//                  each thread of verifyFile with its own stream on the file. The thread stops at the
+//                  first read that fails or comes up short, and marks the chunk as not read.
+//
+//      Parameter:  path is the path of the file.
+//
+//      Parameter:  chunk is the chunk to verify, and receives what was found.
+//
+//      Parameter:  bufferInts is the number of ints read at a time.
+//
+//      Parameter:  checkOrder is false if only the hash is needed.
+//
+//      Parameter:  order is the order the file should be sorted in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+void verifyChunk(const std::string* path, VerifyChunk* chunk, int bufferInts, bool checkOrder, const Order* order)
+{
+	std::ifstream file(*path, std::ios::in | std::ios::binary);
+
+	chunk->firstUnsorted = -1;
+
+	chunk->hash = 0;
+
+	chunk->readFailed = !file.is_open();
+
+	if (chunk->readFailed)
+		return;
+
+	file.seekg(chunk->first * sizeof(int), std::ios::beg);
+
+	int* buffer = new int[bufferInts];
+
+	unsigned long long hash = 0;
+
+	for (long long position = chunk->first; position < chunk->end;)
+	{
+		int numToRead = (chunk->end - position < bufferInts) ? (int)(chunk->end - position) : bufferInts;
+
+		file.read((char*)buffer, numToRead * sizeof(int));
+
+		if (file.gcount() != (std::streamsize)(numToRead * sizeof(int)))
+		{
+			chunk->readFailed = true;
+
+			break;
+		}
+
+		if (position == chunk->first)
+			chunk->firstValue = buffer[0];
+		else if (checkOrder && chunk->firstUnsorted < 0 && (*order)(buffer[0], chunk->lastValue))
+			chunk->firstUnsorted = position;
+
+		hash += hashInts(buffer, numToRead);
+
+		if (checkOrder && chunk->firstUnsorted < 0)
+		{
+			for (int i = 1; i < numToRead; i++)
+			{
+				if ((*order)(buffer[i], buffer[i - 1]))
+				{
+					chunk->firstUnsorted = position + i;
+
+					break;
+				}
+			}
+		}
+
+		chunk->lastValue = buffer[numToRead - 1];
+
+		position += numToRead;
+	}
+
+	chunk->hash = hash;
+
+	delete[] buffer;
+
+	file.close();
+}
+
+#endif
@@ -0,0 +1,418 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort Tests
+//
+//      File Name:    KeyEncodingTests.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the tests of the normalized keys. The keys that the order
+//                    policies give ints, and the composite keys built from columns of ints, floats, and
+//                    strings, must compare with memcmp the same way as the values they were encoded from.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "ExternalSort.h"
+#include "KeyEncoding.h"
+#include "Tests.h"
+#include "TestUtilities.h"
+
+// The number of random pairs of values compared by each test
+static const int NUM_PAIRS = 200000;
+
+// The number of I/O requests the sorts may have in flight
+static const int MAX_IO_IN_FLIGHT = 16;
+
+// A record with a composite key of an ascending int, a descending string, and an ascending float
+struct Record
+{
+	int number;
+
+	std::string name;
+
+	float weight;
+};
+
+template <class Order> static bool testOrderKeys(const std::string&, const Order&);
+template <class Order> static bool testKeyedSort(const std::string&, const Order&);
+static bool testFloatOrder();
+static bool testCompositeKeys();
+static int compareOrder(bool, bool);
+static int sign(int);
+static int encodeRecord(const Record&, unsigned char*);
+static int compareRecords(const Record&, const Record&);
+static Record makeRecord(std::mt19937&);
+static int randomInt(std::mt19937&);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  runKeyEncodingTests
+//
+//        Purpose:  Checks that the normalized keys of every order policy and of composite keys order the
+//                  same way as the values they were encoded from, and that sorting by keys gives the same
+//                  result as sorting by the order they stand for.
+//
+//        Returns:  The number of checks that failed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int runKeyEncodingTests()
+{
+	int numFailed = 0;
+
+	numFailed += !testOrderKeys("Keys of Ascending order like the ints", Ascending());
+
+	numFailed += !testOrderKeys("Keys of Descending order like the ints", Descending());
+
+	numFailed += !testOrderKeys("Keys of AsFloat order like the floats", AsFloat<>());
+
+	numFailed += !testOrderKeys("Keys of descending AsFloat order like the floats", AsFloat<Descending>());
+
+	numFailed += !testOrderKeys("Keys of a Column order like the column", Column<4, 12>());
+
+	numFailed += !testOrderKeys("Keys of a descending Column order like the column", Column<20, 12, Descending>());
+
+	numFailed += !testOrderKeys("Keys of a ThenBy order like both columns", ThenBy<Column<16, 8>, Column<0, 8, Descending>>());
+
+	numFailed += !testOrderKeys("Keys of a ByKey order like its keys", ByKey<ThenBy<Column<16, 8>, Column<0, 8, Descending>>>());
+
+	numFailed += !testFloatOrder();
+
+	numFailed += !testCompositeKeys();
+
+	numFailed += !testKeyedSort("Sorting by keys with ByKey matches sorting by columns", ThenBy<Column<24, 4>, Column<8, 4, Descending>>());
+
+	return numFailed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testOrderKeys
+//
+//        Purpose:  Checks that an order policy and the bytes encodeKey writes for its keys put random
+//                  pairs of ints, and pairs of the ints at the edges of the range, in the same order.
+//
+//      Parameter:  name describes the test.
+//
+//      Parameter:  order is the order policy.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+static bool testOrderKeys(const std::string& name, const Order& order)
+{
+	const int EDGES[] = { 0, 1, -1, 0x7FFFFFFF, (int)0x80000000, 0x7F800000, (int)0xFF800000, 0x7FC00000, 0x00FF00FF };
+
+	const int NUM_EDGES = sizeof(EDGES) / sizeof(EDGES[0]);
+
+	std::mt19937 random(11);
+
+	bool passed = true;
+
+	unsigned char aKey[8];
+
+	unsigned char bKey[8];
+
+	for (int i = 0; i < NUM_PAIRS + NUM_EDGES * NUM_EDGES && passed; i++)
+	{
+		int a = (i < NUM_EDGES * NUM_EDGES) ? EDGES[i / NUM_EDGES] : randomInt(random);
+
+		int b = (i < NUM_EDGES * NUM_EDGES) ? EDGES[i % NUM_EDGES] : randomInt(random);
+
+		int numBytes = encodeKey<Order>(a, aKey);
+
+		encodeKey<Order>(b, bKey);
+
+		passed = sign(memcmp(aKey, bKey, numBytes)) == compareOrder(order(a, b), order(b, a));
+	}
+
+	return check(passed, name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testKeyedSort
+//
+//        Purpose:  Sorts the same ints stably with an order and with ByKey of that order, and checks
+//                  that the two sorted files are the same.
+//
+//      Parameter:  name describes the test.
+//
+//      Parameter:  order is the order to sort by.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+static bool testKeyedSort(const std::string& name, const Order& order)
+{
+	std::mt19937 random(12);
+
+	std::vector<int> input(100000);
+
+	for (int i = 0; i < (int)input.size(); i++)
+		input[i] = randomInt(random);
+
+	setTestFanIn(4);
+
+	writeInts("test-unsorted.bin", input);
+
+	IoBackend io(MAX_IO_IN_FLIGHT);
+
+	std::vector<int> outputs[2];
+
+	for (int i = 0; i < 2; i++)
+	{
+		SortOptions options = testOptions(10000, true);
+
+		std::ifstream unsortedFile("test-unsorted.bin", std::ios::in | std::ios::binary);
+
+		std::string sortedPath = "test-sorted.bin";
+
+		if (i == 0)
+			sortFile(unsortedFile, sortedPath, options, io, order);
+		else
+			sortFile(unsortedFile, sortedPath, options, io, ByKey<Order>());
+
+		unsortedFile.close();
+
+		outputs[i] = readInts(sortedPath);
+
+		remove(sortedPath.c_str());
+	}
+
+	remove("test-unsorted.bin");
+
+	return check(outputs[0].size() == input.size() && outputs[0] == outputs[1], name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testFloatOrder
+//
+//        Purpose:  Checks that AsFloat orders the bits of floats that are not NaN the same way as the
+//                  floats, apart from negative zero coming before positive zero, and that encodeFloat
+//                  gives the same order.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool testFloatOrder()
+{
+	std::mt19937 random(13);
+
+	AsFloat<> order;
+
+	bool passed = true;
+
+	unsigned char aKey[4];
+
+	unsigned char bKey[4];
+
+	for (int i = 0; i < NUM_PAIRS && passed; i++)
+	{
+		int aBits = randomInt(random);
+
+		int bBits = randomInt(random);
+
+		float a;
+
+		float b;
+
+		memcpy(&a, &aBits, sizeof(a));
+
+		memcpy(&b, &bBits, sizeof(b));
+
+		if (std::isnan(a) || std::isnan(b) || (a == 0 && b == 0))
+			continue;
+
+		int expected = (a < b) ? -1 : (b < a) ? 1 : 0;
+
+		encodeFloat(a, false, aKey);
+
+		encodeFloat(b, false, bKey);
+
+		passed = compareOrder(order(aBits, bBits), order(bBits, aBits)) == expected && sign(memcmp(aKey, bKey, 4)) == expected;
+	}
+
+	return check(passed, "AsFloat and encodeFloat order floats by value");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testCompositeKeys
+//
+//        Purpose:  Checks that the composite keys of random records, with many ties in each column and
+//                  names that are prefixes of each other or hold zero bytes, compare with compareKeys the
+//                  same way as the records compare column by column.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool testCompositeKeys()
+{
+	std::mt19937 random(14);
+
+	bool passed = true;
+
+	unsigned char aKey[64];
+
+	unsigned char bKey[64];
+
+	for (int i = 0; i < NUM_PAIRS && passed; i++)
+	{
+		Record a = makeRecord(random);
+
+		Record b = makeRecord(random);
+
+		int aLength = encodeRecord(a, aKey);
+
+		int bLength = encodeRecord(b, bKey);
+
+		passed = sign(compareKeys(aKey, aLength, bKey, bLength)) == compareRecords(a, b);
+	}
+
+	return check(passed, "Composite keys of ints, strings, and floats order like the records");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  compareOrder
+//
+//        Purpose:  Turns the results of comparing two values both ways into -1, 0, or 1.
+//
+//      Parameter:  aFirst is true if the first value comes before the second.
+//
+//      Parameter:  bFirst is true if the second value comes before the first.
+//
+//        Returns:  -1 if the first value comes first, 1 if the second does, or 0 if they are equal.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int compareOrder(bool aFirst, bool bFirst)
+{
+	return aFirst ? -1 : bFirst ? 1 : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  sign
+//
+//        Purpose:  Finds the sign of the result of a comparison.
+//
+//      Parameter:  result is the result.
+//
+//        Returns:  -1, 0, or 1.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int sign(int result)
+{
+	return (result < 0) ? -1 : (result > 0) ? 1 : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  encodeRecord
+//
+//        Purpose:  Encodes the composite key of a record, one column after another.
+//
+//      Parameter:  record is the record.
+//
+//      Parameter:  out is the buffer to write the key to.
+//
+//        Returns:  The number of bytes written.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int encodeRecord(const Record& record, unsigned char* out)
+{
+	int numBytes = encodeInt(record.number, false, out);
+
+	numBytes += encodeString(record.name.data(), (int)record.name.size(), true, out + numBytes);
+
+	numBytes += encodeFloat(record.weight, false, out + numBytes);
+
+	return numBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  compareRecords
+//
+//        Purpose:  Compares two records by their number, then by their name from last to first, then by
+//                  their weight.
+//
+//      Parameter:  a is the first record.
+//
+//      Parameter:  b is the second record.
+//
+//        Returns:  -1 if the first record comes first, 1 if the second does, or 0 if they are equal.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int compareRecords(const Record& a, const Record& b)
+{
+	if (a.number != b.number)
+		return (a.number < b.number) ? -1 : 1;
+
+	// Names are compared as unsigned bytes, which is how std::string compares them
+	int names = a.name.compare(b.name);
+
+	if (names != 0)
+		return -sign(names);
+
+	return (a.weight < b.weight) ? -1 : (b.weight < a.weight) ? 1 : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  makeRecord
+//
+//        Purpose:  Makes a record with values from small sets, so that records often tie on a column.
+//
+//      Parameter:  random is the random number generator.
+//
+//        Returns:  The record.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static Record makeRecord(std::mt19937& random)
+{
+	const int NUMBERS[] = { std::numeric_limits<int>::min(), -7, -1, 0, 1, 7, std::numeric_limits<int>::max() };
+
+	const char NAME_BYTES[] = { 'a', 'b', '\0', '\xFF' };
+
+	const float WEIGHTS[] = { -std::numeric_limits<float>::infinity(), -2.5f, -1e-30f, 0.0f, 1e-30f, 2.5f, std::numeric_limits<float>::infinity() };
+
+	Record record;
+
+	record.number = NUMBERS[random() % (sizeof(NUMBERS) / sizeof(NUMBERS[0]))];
+
+	int nameLength = random() % 4;
+
+	for (int i = 0; i < nameLength; i++)
+		record.name += NAME_BYTES[random() % sizeof(NAME_BYTES)];
+
+	record.weight = WEIGHTS[random() % (sizeof(WEIGHTS) / sizeof(WEIGHTS[0]))];
+
+	return record;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  randomInt
+//
+//        Purpose:  Makes a random int from all 32 bits.
+//
+//      Parameter:  random is the random number generator.
+//
+//        Returns:  The int.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int randomInt(std::mt19937& random)
+{
+	return (int)(unsigned int)random();
+}
\ No newline at end of file
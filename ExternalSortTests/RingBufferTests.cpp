@@ -0,0 +1,175 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort Tests
+//
+//      File Name:    RingBufferTests.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the tests and microbenchmarks of the MpscRing. Several threads
+//                    push numbered items while one thread pops them, and the items of each thread must
+//                    come out in the order they were pushed. The rate the items went through the ring
+//                    is printed for each test, so single and batch pushes can be compared.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.h"
+#include "Tests.h"
+#include "TestUtilities.h"
+
+// The number of low bits of each item that hold its number, with the pushing thread in the rest
+static const int ITEM_NUMBER_BITS = 24;
+
+static bool testMpscRing(const std::string&, int, int);
+static void pushItems(MpscRing<unsigned>*, unsigned, int, int);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  runRingBufferTests
+//
+//        Purpose:  Checks that the MpscRing keeps the items of each pushing thread in order, with one or
+//                  several threads pushing one item or a batch at a time, and times it.
+//
+//        Returns:  The number of checks that failed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int runRingBufferTests()
+{
+	int numFailed = 0;
+
+	numFailed += !testMpscRing("MPSC ring with one thread pushing single items", 1, 1);
+
+	numFailed += !testMpscRing("MPSC ring with one thread pushing batches", 1, 16);
+
+	numFailed += !testMpscRing("MPSC ring with four threads pushing single items", 4, 1);
+
+	numFailed += !testMpscRing("MPSC ring with four threads pushing batches", 4, 16);
+
+	return numFailed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testMpscRing
+//
+//        Purpose:  Pushes items onto a ring from several threads while popping them in batches, checks
+//                  that every item came out once and in the order its thread pushed it, and prints how
+//                  many items went through the ring per second.
+//
+//      Parameter:  name describes the test.
+//
+//      Parameter:  numProducers is the number of threads pushing.
+//
+//      Parameter:  batchSize is the number of items each thread pushes at a time.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool testMpscRing(const std::string& name, int numProducers, int batchSize)
+{
+	const int ITEMS_PER_PRODUCER = 1000000;
+
+	const int RING_CAPACITY = 1024;
+
+	const int POP_BATCH_SIZE = 64;
+
+	MpscRing<unsigned> ring(RING_CAPACITY);
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> producers;
+
+	for (int i = 0; i < numProducers; i++)
+		producers.push_back(std::thread(pushItems, &ring, (unsigned)i, ITEMS_PER_PRODUCER, batchSize));
+
+	// The number of the next item expected from each thread
+	std::vector<unsigned> nextItem(numProducers, 0);
+
+	bool inOrder = true;
+
+	long long numItems = (long long)numProducers * ITEMS_PER_PRODUCER;
+
+	long long numPopped = 0;
+
+	unsigned items[POP_BATCH_SIZE];
+
+	int numWaits = 0;
+
+	while (numPopped < numItems)
+	{
+		int count = ring.tryPopBatch(items, POP_BATCH_SIZE);
+
+		if (count == 0)
+		{
+			waitForRing(numWaits);
+
+			continue;
+		}
+
+		numWaits = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+			unsigned producer = items[i] >> ITEM_NUMBER_BITS;
+
+			unsigned number = items[i] & ((1u << ITEM_NUMBER_BITS) - 1);
+
+			if (producer >= (unsigned)numProducers || number != nextItem[producer])
+				inOrder = false;
+			else
+				nextItem[producer]++;
+		}
+
+		numPopped += count;
+	}
+
+	for (int i = 0; i < numProducers; i++)
+		producers[i].join();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	bool passed = check(inOrder, name);
+
+	std::cout << "        " << numItems / elapsed.count() / 1000000 << " million items per second" << std::endl;
+
+	return passed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  pushItems
+//
+//        Purpose:  Runs on a pushing thread. Pushes items numbered from 0, waiting whenever the ring is
+//                  full.
+//
+//      Parameter:  ring is the ring to push onto.
+//
+//      Parameter:  producer is the number of the thread, which is put in the high bits of its items.
+//
+//      Parameter:  numItems is the number of items to push.
+//
+//      Parameter:  batchSize is the number of items to push at a time.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void pushItems(MpscRing<unsigned>* ring, unsigned producer, int numItems, int batchSize)
+{
+	std::vector<unsigned> batch(batchSize);
+
+	for (int first = 0; first < numItems; first += batchSize)
+	{
+		int count = (numItems - first < batchSize) ? numItems - first : batchSize;
+
+		for (int i = 0; i < count; i++)
+			batch[i] = (producer << ITEM_NUMBER_BITS) | (unsigned)(first + i);
+
+		int numWaits = 0;
+
+		while (ring->tryPushBatch(&batch[0], count) == 0)
+			waitForRing(numWaits);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,274 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort Tests
+//
+//      File Name:    StableSortTests.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the tests of the stable sort and merge on data with many
+//                    duplicate keys. Each int holds a key in its top byte and its position in the
+//                    unsorted data in the rest, and is sorted by an order that only looks at the key, so
+//                    ints with equal keys can be told apart and must come out in order of position.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "ExternalSort.h"
+#include "Tests.h"
+#include "TestUtilities.h"
+
+// The number of low bits of each int that hold its position in the unsorted data
+static const int POSITION_BITS = 24;
+
+// The number of I/O requests the sorts may have in flight
+static const int MAX_IO_IN_FLIGHT = 16;
+
+// Sorts ints by their top byte without a normalized key, so that they are sorted by comparisons and
+// merged with a plain loser tree
+struct TopByteByComparison
+{
+	bool operator()(int a, int b) const
+	{
+		return ((unsigned int)a >> POSITION_BITS) < ((unsigned int)b >> POSITION_BITS);
+	}
+};
+
+template <class Order> static bool testStableSort(const std::string&, const std::vector<int>&, int, int, bool, const Order&);
+template <class Order> static bool testStableMerge(const std::string&, int, int, const Order&);
+template <class Order> static bool isStablySorted(const std::vector<int>&, const std::vector<int>&, const Order&);
+static std::vector<int> makeDuplicateKeys(int, int, int, unsigned int);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  runStableSortTests
+//
+//        Purpose:  Checks that stable sorts and merges keep ints with equal keys in their input order,
+//                  with every kind of run sort and merge tree, over several merge passes.
+//
+//        Returns:  The number of checks that failed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int runStableSortTests()
+{
+	int numFailed = 0;
+
+	numFailed += !testStableSort("Stable sort of ints that all have the same key", makeDuplicateKeys(200000, 1, 0, 1), 10000, 3, false, Column<24, 8>());
+
+	numFailed += !testStableSort("Stable sort of ints with three keys", makeDuplicateKeys(200000, 3, 0, 2), 10000, 3, false, Column<24, 8>());
+
+	numFailed += !testStableSort("Stable sort by a descending key", makeDuplicateKeys(200000, 5, 0, 3), 10000, 4, false, Column<24, 8, Descending>());
+
+	numFailed += !testStableSort("Stable sort by comparisons", makeDuplicateKeys(200000, 4, 0, 4), 10000, 3, false, TopByteByComparison());
+
+	numFailed += !testStableSort("Stable sort merged with offset-value coding", makeDuplicateKeys(200000, 4, 0, 5), 10000, 3, true, Column<24, 8>());
+
+	numFailed += !testStableSort("Stable sort by two columns", makeDuplicateKeys(200000, 256, 0, 6), 10000, 3, false, ThenBy<Column<28, 4>, Column<24, 4, Descending>>());
+
+	numFailed += !testStableSort("Stable sort of chunks read and written asynchronously", makeDuplicateKeys(1000000, 2, 0, 7), 3 * 65536, 4, false, Column<24, 8>());
+
+	numFailed += !testStableMerge("Stable merge of sorted files in one pass", 7, 8, Column<24, 8>());
+
+	numFailed += !testStableMerge("Stable merge of sorted files in several passes", 5, 2, Column<24, 8>());
+
+	return numFailed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testStableSort
+//
+//        Purpose:  Sorts ints stably, and checks that those with equal keys keep their input order.
+//
+//      Parameter:  name describes the test.
+//
+//      Parameter:  input holds the unsorted ints, made by makeDuplicateKeys.
+//
+//      Parameter:  maxFileInts is the maximum number of ints allowed in memory simultaneously, which
+//                  decides how many runs the ints are split into.
+//
+//      Parameter:  fanIn is the fan-in of the merges, which decides how many passes they take.
+//
+//      Parameter:  offsetValueCoding is true if the merges use offset-value coding.
+//
+//      Parameter:  order is the order to sort the ints in.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+static bool testStableSort(const std::string& name, const std::vector<int>& input, int maxFileInts, int fanIn, bool offsetValueCoding, const Order& order)
+{
+	setTestFanIn(fanIn);
+
+	writeInts("test-unsorted.bin", input);
+
+	SortOptions options = testOptions(maxFileInts, true);
+
+	options.offsetValueCoding = offsetValueCoding;
+
+	IoBackend io(MAX_IO_IN_FLIGHT);
+
+	std::ifstream unsortedFile("test-unsorted.bin", std::ios::in | std::ios::binary);
+
+	std::string sortedPath = "test-sorted.bin";
+
+	bool finished = sortFile(unsortedFile, sortedPath, options, io, order);
+
+	unsortedFile.close();
+
+	std::vector<int> output = readInts(sortedPath);
+
+	remove("test-unsorted.bin");
+
+	remove(sortedPath.c_str());
+
+	return check(finished && isStablySorted(input, output, order), name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testStableMerge
+//
+//        Purpose:  Merges sorted files stably, and checks that ints with equal keys keep the order of the
+//                  files they came from, and their order within each file.
+//
+//      Parameter:  name describes the test.
+//
+//      Parameter:  numFiles is the number of files to merge.
+//
+//      Parameter:  fanIn is the fan-in of the merges. If it is less than the number of files, the files
+//                  are merged in groups into temp files first.
+//
+//      Parameter:  order is the order the files are sorted in.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+static bool testStableMerge(const std::string& name, int numFiles, int fanIn, const Order& order)
+{
+	const int INTS_PER_FILE = 20000;
+
+	setTestFanIn(fanIn);
+
+	// The positions carry on from one file to the next, so the files together are the unsorted data
+	std::vector<int> input;
+
+	std::vector<std::string> inputPaths;
+
+	for (int i = 0; i < numFiles; i++)
+	{
+		std::vector<int> file = makeDuplicateKeys(INTS_PER_FILE, 3, i * INTS_PER_FILE, 100 + i);
+
+		input.insert(input.end(), file.begin(), file.end());
+
+		std::stable_sort(file.begin(), file.end(), order);
+
+		inputPaths.push_back("test-input-" + std::to_string(i) + ".bin");
+
+		writeInts(inputPaths[i], file);
+	}
+
+	SortOptions options = testOptions(10000, true);
+
+	IoBackend io(MAX_IO_IN_FLIGHT);
+
+	bool finished = mergeFiles(inputPaths, "test-merged.bin", options, io, order);
+
+	std::vector<int> output = readInts("test-merged.bin");
+
+	for (int i = 0; i < numFiles; i++)
+		remove(inputPaths[i].c_str());
+
+	remove("test-merged.bin");
+
+	return check(finished && isStablySorted(input, output, order), name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  isStablySorted
+//
+//        Purpose:  Checks that the output of a stable sort holds the same ints as its input, in order,
+//                  with ints of equal keys in order of their positions.
+//
+//      Parameter:  input holds the unsorted ints, with the int at each position at that index.
+//
+//      Parameter:  output holds the sorted ints.
+//
+//      Parameter:  order is the order the ints were sorted in.
+//
+//        Returns:  True if the output is stably sorted.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class Order>
+static bool isStablySorted(const std::vector<int>& input, const std::vector<int>& output, const Order& order)
+{
+	if (output.size() != input.size())
+		return false;
+
+	const int POSITION_MASK = (1 << POSITION_BITS) - 1;
+
+	// Every position is unique, so each must be found once, holding the int it held in the input
+	std::vector<bool> found(input.size(), false);
+
+	for (int i = 0; i < (int)output.size(); i++)
+	{
+		int position = output[i] & POSITION_MASK;
+
+		if (position >= (int)input.size() || found[position] || input[position] != output[i])
+			return false;
+
+		found[position] = true;
+
+		if (i == 0)
+			continue;
+
+		if (order(output[i], output[i - 1]))
+			return false;
+
+		// Ints with equal keys must be in order of position
+		if (!order(output[i - 1], output[i]) && (output[i - 1] & POSITION_MASK) > position)
+			return false;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  makeDuplicateKeys
+//
+//        Purpose:  Makes ints with random keys from a small set in their top byte, and their positions
+//                  in the rest.
+//
+//      Parameter:  numInts is the number of ints to make.
+//
+//      Parameter:  numKeys is the number of different keys, at most 256.
+//
+//      Parameter:  firstPosition is the position of the first int.
+//
+//      Parameter:  seed seeds the random keys, so the tests are the same every run.
+//
+//        Returns:  The ints.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::vector<int> makeDuplicateKeys(int numInts, int numKeys, int firstPosition, unsigned int seed)
+{
+	std::mt19937 random(seed);
+
+	std::vector<int> values(numInts);
+
+	for (int i = 0; i < numInts; i++)
+	{
+		unsigned int key = (unsigned int)(random() % numKeys);
+
+		values[i] = (int)((key << POSITION_BITS) | (unsigned int)(firstPosition + i));
+	}
+
+	return values;
+}
\ No newline at end of file
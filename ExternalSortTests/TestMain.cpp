@@ -0,0 +1,46 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort Tests
+//
+//      File Name:    TestMain.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the main function of the tests, which runs every group of tests
+//                    and exits with a failure if any check failed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+
+#include "Tests.h"
+#include "TestUtilities.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  main
+//
+//        Purpose:  Runs the tests in the current directory, which they write their files to.
+//
+//        Returns:  0 if every check passed, or 1 otherwise.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main()
+{
+	int numFailed = 0;
+
+	numFailed += runStableSortTests();
+
+	numFailed += runRingBufferTests();
+
+	numFailed += runKeyEncodingTests();
+
+	removeTestProfile();
+
+	if (numFailed == 0)
+		std::cout << "All tests passed." << std::endl;
+	else
+		std::cout << numFailed << " checks failed." << std::endl;
+
+	return (numFailed == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:    External Sort Tests
+//
+//      File Name:    TestUtilities.cpp
+//
+//         Author:    Nicholas Yoder
+//
+//    Description:    This file contains the definitions of the functions shared by the tests.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "DeviceProfile.h"
+#include "TestUtilities.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  writeInts
+//
+//        Purpose:  Writes ints to a file, replacing it if it exists.
+//
+//      Parameter:  path is the path of the file.
+//
+//      Parameter:  values holds the ints to write.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void writeInts(const std::string& path, const std::vector<int>& values)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!values.empty())
+		file.write((const char*)&values[0], sizeof(int) * values.size());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  readInts
+//
+//        Purpose:  Reads all of the ints of a file.
+//
+//      Parameter:  path is the path of the file.
+//
+//        Returns:  The ints of the file, or no ints if it could not be opened.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<int> readInts(const std::string& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+
+	std::vector<int> values;
+
+	if (!file.is_open())
+		return values;
+
+	file.seekg(0, std::ios::end);
+
+	values.resize((size_t)file.tellg() / sizeof(int));
+
+	file.seekg(0, std::ios::beg);
+
+	if (!values.empty())
+		file.read((char*)&values[0], sizeof(int) * values.size());
+
+	return values;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  testOptions
+//
+//        Purpose:  Builds the options of a sort that writes its temp files to the current directory, and
+//                  that is not indexed, checked, followed, or cancelled.
+//
+//      Parameter:  maxFileInts is the maximum number of ints allowed in memory simultaneously.
+//
+//      Parameter:  stable is true if the sort is stable.
+//
+//        Returns:  The options.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortOptions testOptions(int maxFileInts, bool stable)
+{
+	SortOptions options;
+
+	options.maxFileInts = maxFileInts;
+
+	options.tempPrefix = "test-";
+
+	options.fanIn = 0;
+
+	options.bufferInts = 0;
+
+	options.prefetchBuffers = 0;
+
+	options.outputBuffers = 0;
+
+	options.stable = stable;
+
+	options.offsetValueCoding = false;
+
+	options.indexInterval = 0;
+
+	options.selfCheck = false;
+
+	options.memoryReliefs = 0;
+
+	options.progress = nullptr;
+
+	options.cancel = nullptr;
+
+	return options;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  setTestFanIn
+//
+//        Purpose:  Saves a device profile in the current directory that overrides the fan-in, so that the
+//                  sorts that follow merge in as many passes as a test needs, without measuring the device.
+//
+//      Parameter:  fanIn is the fan-in.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void setTestFanIn(int fanIn)
+{
+	DeviceProfile profile;
+
+	profile.seekSeconds = 0;
+
+	profile.bytesPerSecond = 0;
+
+	profile.fanIn = fanIn;
+
+	profile.bufferInts = 0;
+
+	saveDeviceProfile("", profile);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  removeTestProfile
+//
+//        Purpose:  Removes the device profile saved by setTestFanIn.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+void removeTestProfile()
+{
+	remove("ExternalSort.profile");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Function Name:  check
+//
+//        Purpose:  Reports whether a check passed.
+//
+//      Parameter:  passed is true if the check passed.
+//
+//      Parameter:  description describes what was checked.
+//
+//        Returns:  Whether the check passed.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool check(bool passed, const std::string& description)
+{
+	std::cout << (passed ? "Passed: " : "FAILED: ") << description << std::endl;
+
+	return passed;
+}
\ No newline at end of file
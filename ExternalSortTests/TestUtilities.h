@@ -0,0 +1,31 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort Tests
+//
+//      File Name:  TestUtilities.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the functions shared by the tests, which write and read files of
+//                  ints, build the options of a sort, fix the merge shape of the sorts that follow, and
+//                  report whether a check passed. The tests run in the current directory, and write
+//                  their files and the device profile of the current directory there.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TESTUTILITIES_H
+#define TESTUTILITIES_H
+
+#include <string>
+#include <vector>
+
+#include "SortOptions.h"
+
+void writeInts(const std::string&, const std::vector<int>&);
+std::vector<int> readInts(const std::string&);
+SortOptions testOptions(int, bool);
+void setTestFanIn(int);
+void removeTestProfile();
+bool check(bool, const std::string&);
+
+#endif
\ No newline at end of file
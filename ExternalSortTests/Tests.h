@@ -0,0 +1,21 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//        Project:  External Sort Tests
+//
+//      File Name:  Tests.h
+//
+//         Author:  Nicholas Yoder
+//
+//    Description:  This file contains the functions that run each group of tests. Each prints a line per
+//                  check and returns the number of checks that failed.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TESTS_H
+#define TESTS_H
+
+int runStableSortTests();
+int runRingBufferTests();
+int runKeyEncodingTests();
+
+#endif
\ No newline at end of file